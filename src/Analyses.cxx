@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Analyses.hxx"
+#include "Program.hxx"
+
+#include <algorithm>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+DFUniverse::DFUniverse(const CFG &g) : _g(g)
+{
+    map<string, size_t> exprbit;
+    /* per expression: the variables it reads */
+    vector<vector<varid> > operands;
+
+    this->_locals.resize(g.size());
+    this->_computes.resize(g.size());
+    for (unsigned n = 0; n < g.size(); ++n) {
+        const CFGNode &node = g.node(n);
+        if (CFG_STMT != node.kind && CFG_TEST != node.kind) continue;
+        DFLocals &f = this->_locals[n];
+        node.stmt->dflocals(f);
+        if (f.defines) this->_varbit.insert(make_pair(f.def, 0));
+        for (varid v : f.uses) this->_varbit.insert(make_pair(v, 0));
+        for (const Expression *e : f.exprs) {
+            auto i = exprbit.insert(make_pair(e->str(false),
+                                              this->_exprs.size()));
+            if (i.second) {
+                this->_exprs.push_back(i.first->first);
+                DFLocals sub;
+                e->dflocals(sub);
+                operands.push_back(sub.uses);
+            }
+            this->_computes[n].push_back(i.first->second);
+        }
+    }
+    /* variables are numbered in id order */
+    for (auto &v : this->_varbit) {
+        v.second = this->_vars.size();
+        this->_vars.push_back(v.first);
+    }
+    this->_readers.assign(this->_vars.size(), BitVector(this->_exprs.size()));
+    for (size_t e = 0; e < operands.size(); ++e) {
+        for (varid v : operands[e]) {
+            this->_readers[this->varbit(v)].set(e);
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+RDAnalysis::RDAnalysis(const CFG &g, const DefTable &defs) : _defs(defs)
+{
+    this->_gen.assign(g.size(), DefTable::NONE);
+    this->_kill.assign(g.size(), NULL);
+    for (unsigned n = 0; n < g.size(); ++n) {
+        if (CFG_STMT != g.node(n).kind) continue;
+        size_t d = defs.defAt(g.node(n).label);
+        if (DefTable::NONE == d) continue;
+        this->_gen[n] = d;
+        this->_kill[n] = &defs.kill(d);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+RDAnalysis::publish(const CFG &g, const DFSolver<RDAnalysis> &s)
+{
+    for (unsigned n = 0; n < g.size(); ++n) {
+        const CFGNode &node = g.node(n);
+        switch (node.kind) {
+            case CFG_STMT:
+            case CFG_TEST:
+                node.stmt->rdbits(s.entry(n), s.exit(n));
+                break;
+            case CFG_MERGE:
+                node.owner->rdbits(s.entry(n), s.exit(n));
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* live on entry: read here, or live on exit and not written here */
+LiveVariables::LiveVariables(const DFUniverse &u) :
+    DFGenKill(u.nvars(), u.cfg().size())
+{
+    for (unsigned n = 0; n < u.cfg().size(); ++n) {
+        const DFLocals &f = u.locals(n);
+        if (f.defines) this->_kill[n].set(u.varbit(f.def));
+        for (varid v : f.uses) this->_gen[n].set(u.varbit(v));
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* available on exit: computed here and not invalidated by the assignment
+ * that follows, or available on entry and not invalidated */
+AvailableExpressions::AvailableExpressions(const DFUniverse &u) :
+    DFGenKill(u.nexprs(), u.cfg().size())
+{
+    for (unsigned n = 0; n < u.cfg().size(); ++n) {
+        const DFLocals &f = u.locals(n);
+        for (size_t e : u.computes(n)) this->_gen[n].set(e);
+        if (f.defines) {
+            this->_kill[n] = u.readers(u.varbit(f.def));
+            this->_gen[n].andNot(this->_kill[n]);
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* very busy on entry: computed here (before any assignment), or very busy on
+ * exit and its operands are not assigned here */
+VeryBusyExpressions::VeryBusyExpressions(const DFUniverse &u) :
+    DFGenKill(u.nexprs(), u.cfg().size())
+{
+    for (unsigned n = 0; n < u.cfg().size(); ++n) {
+        const DFLocals &f = u.locals(n);
+        for (size_t e : u.computes(n)) this->_gen[n].set(e);
+        if (f.defines) this->_kill[n] = u.readers(u.varbit(f.def));
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+dfemitSet(ostream &os,
+          const SymbolTable &syms,
+          const DFUniverse &u,
+          const BitVector &b,
+          bool vars)
+{
+    os << "{";
+    if (vars) {
+        /* print in name order */
+        vector<varid> byname;
+        for (size_t i = b.next(0); i < b.size(); i = b.next(i + 1)) {
+            byname.push_back(u.var(i));
+        }
+        stable_sort(byname.begin(), byname.end(),
+                    [&syms](varid a, varid c) {
+                        return syms.rank(a) < syms.rank(c);
+                    });
+        for (varid v : byname) os << " " << syms.name(v);
+    }
+    else {
+        for (size_t i = b.next(0); i < b.size(); i = b.next(i + 1)) {
+            os << " (" << u.expr(i) << ")";
+        }
+    }
+    os << " }" << endl;
+}
@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALYSES_H_INCLUDED
+#define ANALYSES_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "BitVector.hxx"
+#include "CFG.hxx"
+#include "Dataflow.hxx"
+#include "ReachingDefs.hxx"
+#include "SymbolTable.hxx"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+
+class Expression;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* what one control flow graph node reads and writes */
+struct DFLocals {
+    /* assigned variable, if any */
+    bool defines;
+    varid def;
+    /* variables read */
+    std::vector<varid> uses;
+    /* non-trivial arithmetic expressions computed, innermost first */
+    std::vector<const Expression *> exprs;
+
+    DFLocals(void) : defines(false), def(0) { ; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* the local facts of every node of a control flow graph, and the dense
+ * numbering of variables and expressions the analyses use as bit indices. */
+class DFUniverse {
+private:
+    const CFG &_g;
+    std::vector<DFLocals> _locals;
+    /* bit -> variable, and variable -> bit */
+    std::vector<varid> _vars;
+    std::map<varid, size_t> _varbit;
+    /* bit -> expression text, first occurrence first */
+    std::vector<std::string> _exprs;
+    /* per node: bits of the expressions it computes */
+    std::vector<std::vector<size_t> > _computes;
+    /* per variable bit: the expressions that read it */
+    std::vector<BitVector> _readers;
+
+    DFUniverse(void);
+
+public:
+    DFUniverse(const CFG &g);
+
+    ~DFUniverse(void) { ; }
+
+    const CFG &cfg(void) const { return this->_g; }
+
+    const DFLocals &locals(unsigned n) const { return this->_locals[n]; }
+
+    size_t nvars(void) const { return this->_vars.size(); }
+
+    size_t varbit(varid v) const { return this->_varbit.find(v)->second; }
+
+    varid var(size_t b) const { return this->_vars[b]; }
+
+    size_t nexprs(void) const { return this->_exprs.size(); }
+
+    const std::string &expr(size_t b) const { return this->_exprs[b]; }
+
+    const std::vector<size_t> &computes(unsigned n) const {
+        return this->_computes[n];
+    }
+    /* expressions invalidated by assigning variable bit b */
+    const BitVector &readers(size_t b) const { return this->_readers[b]; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* transfer functions of the form out = gen | (in & ~kill) */
+class DFGenKill {
+protected:
+    size_t _width;
+    std::vector<BitVector> _gen, _kill;
+
+    DFGenKill(size_t width, unsigned nnodes) :
+        _width(width),
+        _gen(nnodes, BitVector(width)),
+        _kill(nnodes, BitVector(width)) { ; }
+
+public:
+    size_t width(void) const { return this->_width; }
+
+    void boundary(BitVector &b) const { b.clear(); }
+
+    void transfer(unsigned n, BitVector &x) const {
+        x.andNot(this->_kill[n]);
+        x |= this->_gen[n];
+    }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* reaching definitions. the same transfer function RDWorklist uses. */
+class RDAnalysis {
+private:
+    const DefTable &_defs;
+    std::vector<size_t> _gen;
+    std::vector<const BitVector *> _kill;
+
+    RDAnalysis(void);
+
+public:
+    static const DFDirection DIRECTION = DF_FORWARD;
+    typedef DFUnion Meet;
+
+    RDAnalysis(const CFG &g, const DefTable &defs);
+
+    size_t width(void) const { return this->_defs.size(); }
+
+    void boundary(BitVector &b) const { b = this->_defs.startSet(); }
+
+    void transfer(unsigned n, BitVector &x) const {
+        if (DefTable::NONE == this->_gen[n]) return;
+        x.andNot(*this->_kill[n]);
+        x.set(this->_gen[n]);
+    }
+    /* hand results to the statements so rdsync and emitrd can use them */
+    static void publish(const CFG &g, const DFSolver<RDAnalysis> &s);
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+class LiveVariables : public DFGenKill {
+public:
+    static const DFDirection DIRECTION = DF_BACKWARD;
+    typedef DFUnion Meet;
+
+    LiveVariables(const DFUniverse &u);
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+class AvailableExpressions : public DFGenKill {
+public:
+    static const DFDirection DIRECTION = DF_FORWARD;
+    typedef DFIntersect Meet;
+
+    AvailableExpressions(const DFUniverse &u);
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+class VeryBusyExpressions : public DFGenKill {
+public:
+    static const DFDirection DIRECTION = DF_BACKWARD;
+    typedef DFIntersect Meet;
+
+    VeryBusyExpressions(const DFUniverse &u);
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* prints the entry and exit sets of every statement and test. vars selects
+ * whether bits are variables or expressions. */
+void dfemitSet(std::ostream &os,
+               const SymbolTable &syms,
+               const DFUniverse &u,
+               const BitVector &b,
+               bool vars);
+
+template <typename A>
+void
+dfemit(std::ostream &os,
+       const SymbolTable &syms,
+       const DFUniverse &u,
+       const DFSolver<A> &s,
+       bool vars)
+{
+    const CFG &g = u.cfg();
+
+    for (unsigned n = 0; n < g.size(); ++n) {
+        const CFGNode &node = g.node(n);
+        if (CFG_STMT != node.kind && CFG_TEST != node.kind) continue;
+        dfemitSet(os, syms, u, s.entry(n), vars);
+        os << "[" << g.text(n) << "] -- " << node.label << std::endl;
+        dfemitSet(os, syms, u, s.exit(n), vars);
+    }
+}
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Arena.hxx"
+
+#include <cstdlib>
+
+#include <stdint.h>
+
+using namespace std;
+
+const size_t Arena::CHUNK_SIZE = 64 * 1024;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void *
+Arena::alloc(size_t size, size_t align)
+{
+    size_t pad = (align - (reinterpret_cast<uintptr_t>(this->_cur) % align)) %
+                 align;
+
+    if (NULL == this->_cur || pad + size > this->_left) {
+        /* big requests get a chunk of their own */
+        size_t csize = size + align > Arena::CHUNK_SIZE ? size + align
+                                                        : Arena::CHUNK_SIZE;
+        char *chunk = static_cast<char *>(malloc(csize));
+        if (NULL == chunk) throw bad_alloc();
+        this->_chunks.push_back(chunk);
+        Stats::count(STAT_ARENA_CHUNKS);
+        this->_cur = chunk;
+        this->_left = csize;
+        pad = (align - (reinterpret_cast<uintptr_t>(this->_cur) % align)) %
+              align;
+    }
+    void *mem = this->_cur + pad;
+    this->_cur += pad + size;
+    this->_left -= pad + size;
+    this->_bytes += size;
+    Stats::count(STAT_ARENA_BYTES, size);
+    return mem;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Arena::release(void)
+{
+    for (auto d = this->_dtors.rbegin(); d != this->_dtors.rend(); ++d) {
+        d->fn(d->obj);
+    }
+    for (char *c : this->_chunks) free(c);
+    this->_dtors.clear();
+    this->_chunks.clear();
+    this->_cur = NULL;
+    this->_left = 0;
+    this->_bytes = 0;
+    this->_nobjs = 0;
+}
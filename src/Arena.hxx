@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+#include "Stats.hxx"
+
+/* bump allocator. everything made in an arena lives until release, which
+ * runs any destructors (newest first) and frees all memory at once. */
+class Arena {
+private:
+    static const size_t CHUNK_SIZE;
+
+    struct Dtor {
+        void (*fn)(void *);
+        void *obj;
+    };
+    /* backing memory */
+    std::vector<char *> _chunks;
+    /* bump pointer and what is left in the current chunk */
+    char *_cur;
+    size_t _left;
+    /* objects that need their destructors run */
+    std::vector<Dtor> _dtors;
+    /* stats */
+    size_t _bytes, _nobjs;
+
+    template <typename T>
+    static void destroy(void *obj) { static_cast<T *>(obj)->~T(); }
+
+    Arena(const Arena &);
+    Arena &operator=(const Arena &);
+
+public:
+    Arena(void) : _cur(NULL), _left(0), _bytes(0), _nobjs(0) { ; }
+
+    ~Arena(void) { this->release(); }
+
+    void *alloc(size_t size, size_t align);
+
+    template <typename T, typename... Args>
+    T *make(Args &&...args) {
+        void *mem = this->alloc(sizeof(T), alignof(T));
+        T *obj = new (mem) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            Dtor d = {&Arena::destroy<T>, obj};
+            this->_dtors.push_back(d);
+        }
+        ++this->_nobjs;
+        Stats::count(STAT_ARENA_OBJECTS);
+        return obj;
+    }
+
+    void release(void);
+    /* bytes handed out so far */
+    size_t bytes(void) const { return this->_bytes; }
+    /* objects made so far */
+    size_t nobjs(void) const { return this->_nobjs; }
+};
+
+#endif
@@ -25,9 +25,13 @@
 #include <cstdio>
 #include <algorithm>
 #include <sstream>
+#include <locale>
+#include <climits>
+#include <cmath>
 
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
 
 using namespace std;
 
@@ -35,39 +39,114 @@ using namespace std;
 string
 Base::int2string(int i)
 {
-    char tmpBuf[256];
+    char buf[16];
+    char *end = buf + sizeof(buf), *p = end;
+    unsigned u = i < 0 ? 0U - unsigned(i) : unsigned(i);
 
-    fill_n(tmpBuf, sizeof(tmpBuf), '\0');
-    snprintf(tmpBuf, sizeof(tmpBuf) - 1, "%d", i);
-    return string(tmpBuf);
+    do {
+        *--p = '0' + u % 10;
+    } while (0 != (u /= 10));
+    if (i < 0) *--p = '-';
+    return string(p, end);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
 int
 Base::string2int(const string &str)
 {
-    int num = 0;
-    istringstream(str) >> num;
-    return num;
+    return Base::string2int(str.data(), str.size());
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* same as reading an int from a stream: leading space, an optional sign, then
+ * digits up to the first non-digit. out of range values saturate. */
+int
+Base::string2int(const char *s, size_t len)
+{
+    const int64_t lim = int64_t(INT_MAX) + 1;
+    int64_t num = 0;
+    bool neg = false;
+    size_t i = 0;
+
+    while (i < len && isspace(static_cast<unsigned char>(s[i]))) ++i;
+    if (i < len && ('-' == s[i] || '+' == s[i])) neg = '-' == s[i++];
+    for (; i < len && isdigit(static_cast<unsigned char>(s[i])); ++i) {
+        num = num * 10 + (s[i] - '0');
+        if (num > lim) num = lim;
+    }
+    if (neg) return int(-num);
+    return num > INT_MAX ? INT_MAX : int(num);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
+/* prints like %f. f * 1e6 is exact in a double whenever it fits in 64 bits,
+ * so rounding it to an integer rounds the same way printf does. */
 string
 Base::float2string(float f)
 {
-    char tmpBuf[256];
+    char buf[64];
 
-    fill_n(tmpBuf, sizeof(tmpBuf), '\0');
-    snprintf(tmpBuf, sizeof(tmpBuf) - 1, "%f", f);
-    return string(tmpBuf);
+    if (!isfinite(f) || fabs(f) >= 1e12) {
+        snprintf(buf, sizeof(buf), "%f", f);
+        return string(buf);
+    }
+    char *end = buf + sizeof(buf), *p = end;
+    uint64_t u = uint64_t(fabs(rint(double(f) * 1e6)));
+    for (int d = 0; d < 6; ++d, u /= 10) *--p = '0' + u % 10;
+    *--p = '.';
+    do {
+        *--p = '0' + u % 10;
+    } while (0 != (u /= 10));
+    if (signbit(f)) *--p = '-';
+    return string(p, end);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
 float
 Base::string2float(const string &str)
 {
+    return Base::string2float(str.data(), str.size());
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* literals of the form digits[.digits] with at most 24 significant bits and
+ * ten fractional digits are exact quotients of two floats, so one division
+ * rounds them correctly. anything else goes through a classic-locale stream,
+ * as before. */
+float
+Base::string2float(const char *s, size_t len)
+{
+    static const float pow10[] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+    uint64_t mant = 0;
+    int frac = 0;
+    bool dot = false, fast = 0 != len;
+
+    for (size_t i = 0; fast && i < len; ++i) {
+        if ('.' == s[i] && !dot) {
+            dot = true;
+        }
+        else if (isdigit(static_cast<unsigned char>(s[i])) &&
+                 mant < (uint64_t(1) << 56)) {
+            mant = mant * 10 + (s[i] - '0');
+            if (dot) ++frac;
+        }
+        else {
+            fast = false;
+        }
+    }
+    while (fast && 0 != frac && 0 == mant % 10) {
+        mant /= 10;
+        --frac;
+    }
+    if (fast && mant <= (uint64_t(1) << 24) && frac <= 10) {
+        return float(mant) / pow10[frac];
+    }
     float num = 0;
-    istringstream(str) >> num;
+    istringstream is(string(s, len));
+    is.imbue(locale::classic());
+    is >> num;
     return num;
 }
 
@@ -89,7 +168,5 @@ Base::bool2string(bool b)
 string
 Base::pad(unsigned pad)
 {
-    string out = "";
-    for (unsigned i = 0; i < pad; ++i) out += "  ";
-    return out;
+    return string(2 * size_t(pad), ' ');
 }
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <iostream>
+#include <cstddef>
 
 class Base {
 private:
@@ -34,10 +35,14 @@ public:
     static std::string int2string(int i);
 
     static int string2int(const std::string &str);
+    /* for len chars at s, which need not be terminated */
+    static int string2int(const char *s, size_t len);
 
     static std::string float2string(float f);
 
     static float string2float(const std::string &str);
+    /* for len chars at s, which need not be terminated */
+    static float string2float(const char *s, size_t len);
 
     static bool string2bool(const std::string &str);
 
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BasicBlocks.hxx"
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+BasicBlocks::BasicBlocks(const CFG &g) : _g(g)
+{
+    unsigned nn = g.size();
+
+    this->_blockOf.assign(nn, CFG::NONE);
+    this->_boff.push_back(0);
+    this->_members.reserve(nn);
+    /* grow a block from every leader. a pass that finds nothing but
+     * unclaimed nodes can only be looking at a cycle with no way in, so
+     * the second pass just starts a block anywhere. */
+    for (unsigned pass = 0; pass < 2; ++pass) {
+        for (unsigned n = 0; n < nn; ++n) {
+            if (CFG::NONE != this->_blockOf[n]) continue;
+            if (0 == pass && !this->leader(n)) continue;
+            unsigned b = this->_boff.size() - 1;
+            unsigned cur = n;
+            while (true) {
+                this->_blockOf[cur] = b;
+                this->_members.push_back(cur);
+                if (1 != g.nsuccs(cur)) break;
+                cur = g.succs(cur)[0];
+                if (CFG::NONE != this->_blockOf[cur] || this->leader(cur)) break;
+            }
+            this->_boff.push_back(this->_members.size());
+        }
+    }
+    /* block edges leave from the last node of a block */
+    unsigned nb = this->size();
+    vector<pair<unsigned, unsigned> > edges;
+    for (unsigned b = 0; b < nb; ++b) {
+        unsigned last = this->nodes(b)[this->nnodes(b) - 1];
+        for (unsigned s = 0; s < g.nsuccs(last); ++s) {
+            edges.push_back(make_pair(b, this->_blockOf[g.succs(last)[s]]));
+        }
+    }
+    this->_soff.assign(nb + 1, 0);
+    this->_poff.assign(nb + 1, 0);
+    for (const auto &e : edges) {
+        ++this->_soff[e.first + 1];
+        ++this->_poff[e.second + 1];
+    }
+    for (unsigned b = 0; b < nb; ++b) {
+        this->_soff[b + 1] += this->_soff[b];
+        this->_poff[b + 1] += this->_poff[b];
+    }
+    this->_succ.resize(edges.size());
+    this->_pred.resize(edges.size());
+    vector<unsigned> sfill(this->_soff.begin(), this->_soff.end() - 1);
+    vector<unsigned> pfill(this->_poff.begin(), this->_poff.end() - 1);
+    for (const auto &e : edges) {
+        this->_succ[sfill[e.first]++] = e.second;
+        this->_pred[pfill[e.second]++] = e.first;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* n starts a block unless it is the only successor of its only predecessor */
+bool
+BasicBlocks::leader(unsigned n) const
+{
+    if (this->_g.entry() == n || 1 != this->_g.npreds(n)) return true;
+    return 1 != this->_g.nsuccs(this->_g.preds(n)[0]);
+}
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BASIC_BLOCKS_H_INCLUDED
+#define BASIC_BLOCKS_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "CFG.hxx"
+
+#include <vector>
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* partitions a control flow graph into maximal straight-line runs of nodes.
+ * blocks have the same graph interface as the CFG they came from. */
+class BasicBlocks {
+private:
+    const CFG &_g;
+    /* block b is made of _members[_boff[b]] ... _members[_boff[b + 1] - 1] */
+    std::vector<unsigned> _boff, _members;
+    /* node -> block */
+    std::vector<unsigned> _blockOf;
+    /* successor offsets and targets */
+    std::vector<unsigned> _soff, _succ;
+    /* predecessor offsets and sources */
+    std::vector<unsigned> _poff, _pred;
+
+    BasicBlocks(void);
+
+    bool leader(unsigned n) const;
+
+public:
+    BasicBlocks(const CFG &g);
+
+    ~BasicBlocks(void) { ; }
+
+    const CFG &cfg(void) const { return this->_g; }
+
+    unsigned size(void) const { return this->_boff.size() - 1; }
+
+    unsigned entry(void) const { return this->_blockOf[this->_g.entry()]; }
+
+    unsigned blockOf(unsigned n) const { return this->_blockOf[n]; }
+
+    unsigned nnodes(unsigned b) const {
+        return this->_boff[b + 1] - this->_boff[b];
+    }
+    /* nodes of block b in execution order */
+    const unsigned *nodes(unsigned b) const {
+        return this->_members.data() + this->_boff[b];
+    }
+
+    unsigned nsuccs(unsigned b) const {
+        return this->_soff[b + 1] - this->_soff[b];
+    }
+
+    const unsigned *succs(unsigned b) const {
+        return this->_succ.data() + this->_soff[b];
+    }
+
+    unsigned npreds(unsigned b) const {
+        return this->_poff[b + 1] - this->_poff[b];
+    }
+
+    const unsigned *preds(unsigned b) const {
+        return this->_pred.data() + this->_poff[b];
+    }
+};
+
+#endif
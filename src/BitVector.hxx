@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BIT_VECTOR_H_INCLUDED
+#define BIT_VECTOR_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+#include <cstddef>
+
+#include <stdint.h>
+
+/* fixed-size set of dense indices. all set operations are word-wise. */
+class BitVector {
+private:
+    static const unsigned WBITS = 64;
+    /* number of valid bits */
+    size_t _nbits;
+    /* backing store -- bits past _nbits are always zero */
+    std::vector<uint64_t> _words;
+
+public:
+    BitVector(void) : _nbits(0) { ; }
+
+    explicit BitVector(size_t nbits) :
+        _nbits(nbits), _words((nbits + WBITS - 1) / WBITS, 0) { ; }
+
+    size_t size(void) const { return this->_nbits; }
+
+    size_t nwords(void) const { return this->_words.size(); }
+
+    uint64_t word(size_t w) const { return this->_words[w]; }
+    /* callers must keep bits past size() zero */
+    uint64_t &word(size_t w) { return this->_words[w]; }
+
+    void resize(size_t nbits) {
+        this->_nbits = nbits;
+        this->_words.assign((nbits + WBITS - 1) / WBITS, 0);
+    }
+
+    void clear(void) {
+        for (auto &w : this->_words) w = 0;
+    }
+
+    /* sets every bit below size() */
+    void fill(void) {
+        for (auto &w : this->_words) w = ~uint64_t(0);
+        if (this->_nbits % WBITS) {
+            this->_words.back() >>= WBITS - this->_nbits % WBITS;
+        }
+    }
+
+    void set(size_t i) {
+        this->_words[i / WBITS] |= (uint64_t(1) << (i % WBITS));
+    }
+
+    bool test(size_t i) const {
+        return 0 != (this->_words[i / WBITS] & (uint64_t(1) << (i % WBITS)));
+    }
+
+    bool any(void) const {
+        for (auto w : this->_words) if (w) return true;
+        return false;
+    }
+
+    /* this = this | o */
+    BitVector &operator|=(const BitVector &o) {
+        for (size_t w = 0; w < this->_words.size(); ++w) {
+            this->_words[w] |= o._words[w];
+        }
+        return *this;
+    }
+
+    /* this = this & o */
+    BitVector &operator&=(const BitVector &o) {
+        for (size_t w = 0; w < this->_words.size(); ++w) {
+            this->_words[w] &= o._words[w];
+        }
+        return *this;
+    }
+
+    /* this = this & ~o */
+    BitVector &andNot(const BitVector &o) {
+        for (size_t w = 0; w < this->_words.size(); ++w) {
+            this->_words[w] &= ~o._words[w];
+        }
+        return *this;
+    }
+
+    bool operator==(const BitVector &o) const {
+        return this->_nbits == o._nbits && this->_words == o._words;
+    }
+
+    bool operator!=(const BitVector &o) const { return !(*this == o); }
+
+    /* returns the first set bit at or after i, or size() if there is none */
+    size_t next(size_t i) const {
+        if (i >= this->_nbits) return this->_nbits;
+        size_t w = i / WBITS;
+        uint64_t cur = this->_words[w] & (~uint64_t(0) << (i % WBITS));
+        while (true) {
+            if (cur) return w * WBITS + __builtin_ctzll(cur);
+            if (++w == this->_words.size()) return this->_nbits;
+            cur = this->_words[w];
+        }
+    }
+};
+
+#endif
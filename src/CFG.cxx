@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CFG.hxx"
+#include "Program.hxx"
+
+using namespace std;
+
+const unsigned CFG::NONE = ~0U;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+unsigned
+CFG::newNode(CFGNodeKind kind, Statement *stmt, Statement *owner)
+{
+    CFGNode n;
+    n.kind = kind;
+    n.stmt = stmt;
+    n.owner = owner;
+    n.label = stmt ? stmt->label() : 0;
+
+    unsigned id = this->_nodes.size();
+    this->_nodes.push_back(n);
+    if (CFG_ENTRY == kind) this->_entry = id;
+    if (CFG_EXIT == kind) this->_exit = id;
+    return id;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+unsigned
+CFG::newNode(CFGNodeKind kind, int label)
+{
+    unsigned id = this->newNode(kind);
+    this->_nodes[id].label = label;
+    return id;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+CFG::finalize(void)
+{
+    unsigned nn = this->_nodes.size();
+
+    this->_soff.assign(nn + 1, 0);
+    this->_poff.assign(nn + 1, 0);
+    for (const auto &e : this->_edges) {
+        ++this->_soff[e.first + 1];
+        ++this->_poff[e.second + 1];
+    }
+    for (unsigned n = 0; n < nn; ++n) {
+        this->_soff[n + 1] += this->_soff[n];
+        this->_poff[n + 1] += this->_poff[n];
+    }
+    this->_succ.resize(this->_edges.size());
+    this->_pred.resize(this->_edges.size());
+    /* fill in insertion order so neighbor order is stable */
+    vector<unsigned> sfill(this->_soff.begin(), this->_soff.end() - 1);
+    vector<unsigned> pfill(this->_poff.begin(), this->_poff.end() - 1);
+    for (const auto &e : this->_edges) {
+        this->_succ[sfill[e.first]++] = e.second;
+        this->_pred[pfill[e.second]++] = e.first;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+string
+CFG::text(unsigned n) const
+{
+    const CFGNode &node = this->_nodes[n];
+    switch (node.kind) {
+        case CFG_ENTRY: return "[[PROGRAM]]";
+        case CFG_EXIT: return "[[PROGRAM END]]";
+        case CFG_STMT: return node.stmt->cfglabel();
+        case CFG_TEST: return node.owner->cfglabel();
+        default: return " ";
+    }
+}
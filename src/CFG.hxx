@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CFG_H_INCLUDED
+#define CFG_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+class Statement;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+enum CFGNodeKind {
+    /* [[PROGRAM]] */
+    CFG_ENTRY = 0,
+    /* [[PROGRAM END]] */
+    CFG_EXIT,
+    /* assignment or skip */
+    CFG_STMT,
+    /* if or while test */
+    CFG_TEST,
+    /* join after an if or while */
+    CFG_MERGE
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+struct CFGNode {
+    CFGNodeKind kind;
+    /* label of stmt, 0 for entry and exit */
+    int label;
+    /* the statement this node stands for. for tests this is the expression
+     * statement, for merges it is the if or while. NULL for entry and exit. */
+    Statement *stmt;
+    /* the if or while a test or merge belongs to */
+    Statement *owner;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* control flow graph. nodes are numbered densely in creation order. edges are
+ * added freely and then packed into compressed successor and predecessor
+ * arrays by finalize. */
+class CFG {
+private:
+    std::vector<CFGNode> _nodes;
+    /* edges in insertion order */
+    std::vector<std::pair<unsigned, unsigned> > _edges;
+    /* successor offsets and targets */
+    std::vector<unsigned> _soff, _succ;
+    /* predecessor offsets and sources */
+    std::vector<unsigned> _poff, _pred;
+    unsigned _entry, _exit;
+
+public:
+    static const unsigned NONE;
+
+    CFG(void) : _entry(CFG::NONE), _exit(CFG::NONE) { ; }
+
+    ~CFG(void) { ; }
+
+    unsigned newNode(CFGNodeKind kind,
+                     Statement *stmt = NULL,
+                     Statement *owner = NULL);
+    /* for graphs built without statements, like a FlatAST's */
+    unsigned newNode(CFGNodeKind kind, int label);
+
+    void newEdge(unsigned from, unsigned to) {
+        this->_edges.push_back(std::make_pair(from, to));
+    }
+    /* pack edges into successor and predecessor arrays */
+    void finalize(void);
+
+    unsigned size(void) const { return this->_nodes.size(); }
+
+    unsigned nedges(void) const { return this->_edges.size(); }
+
+    unsigned entry(void) const { return this->_entry; }
+
+    unsigned exit(void) const { return this->_exit; }
+
+    const CFGNode &node(unsigned n) const { return this->_nodes[n]; }
+
+    const std::pair<unsigned, unsigned> &edge(unsigned e) const {
+        return this->_edges[e];
+    }
+
+    unsigned nsuccs(unsigned n) const {
+        return this->_soff[n + 1] - this->_soff[n];
+    }
+
+    const unsigned *succs(unsigned n) const {
+        return this->_succ.data() + this->_soff[n];
+    }
+
+    unsigned npreds(unsigned n) const {
+        return this->_poff[n + 1] - this->_poff[n];
+    }
+
+    const unsigned *preds(unsigned n) const {
+        return this->_pred.data() + this->_poff[n];
+    }
+    /* text used when drawing node n */
+    std::string text(unsigned n) const;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* fills order with the nodes of g reachable from entry in reverse postorder
+ * and num with each node's position in order (NONE if unreachable). works for
+ * any graph type with size, nsuccs and succs. */
+template <typename G>
+void
+reversePostorder(const G &g,
+                 unsigned entry,
+                 std::vector<unsigned> &order,
+                 std::vector<unsigned> &num)
+{
+    std::vector<bool> seen(g.size(), false);
+    /* node, next successor to look at */
+    std::vector<std::pair<unsigned, unsigned> > stack;
+
+    order.clear();
+    order.reserve(g.size());
+    stack.push_back(std::make_pair(entry, 0U));
+    seen[entry] = true;
+    while (!stack.empty()) {
+        std::pair<unsigned, unsigned> &top = stack.back();
+        if (top.second < g.nsuccs(top.first)) {
+            unsigned s = g.succs(top.first)[top.second++];
+            if (!seen[s]) {
+                seen[s] = true;
+                stack.push_back(std::make_pair(s, 0U));
+            }
+        }
+        else {
+            order.push_back(top.first);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    num.assign(g.size(), CFG::NONE);
+    for (unsigned i = 0; i < order.size(); ++i) num[order[i]] = i;
+}
+
+#endif
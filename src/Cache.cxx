@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Cache.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* first line of every entry, followed by the length of what comes after */
+static const char MAGIC[] = "dflow-cache 1 ";
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static inline uint64_t
+rotl(uint64_t x, unsigned r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* final avalanche */
+static inline uint64_t
+fmix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* two independent multiply-rotate lanes over 8-byte words. fast and well
+ * mixed, not cryptographic: the cache trusts whoever can write to it. */
+static void
+hash128(const char *data, size_t size, uint64_t &a, uint64_t &b)
+{
+    size_t i = 0;
+    uint64_t w;
+
+    for (; i + 8 <= size; i += 8) {
+        memcpy(&w, data + i, 8);
+        a = rotl(a ^ (w * 0x87c37b91114253d5ULL), 31) * 0x9e3779b97f4a7c15ULL;
+        b = rotl(b + (w * 0x4cf5ad432745937fULL), 29) * 0xbf58476d1ce4e5b9ULL;
+    }
+    w = 0;
+    memcpy(&w, data + i, size - i);
+    a = fmix(a ^ w ^ size);
+    b = fmix(b + w + a);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static string
+why(const string &what, const string &path, int err)
+{
+    return what + ": " + path + ". why: " + strerror(err) + ".";
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* writes all of text to fd */
+static bool
+writeAll(int fd, const char *text, size_t size)
+{
+    while (0 != size) {
+        ssize_t n = write(fd, text, size);
+        if (-1 == n) {
+            if (EINTR == errno) continue;
+            return false;
+        }
+        text += n;
+        size -= n;
+    }
+    return true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* true if name is one key wrote. the directory may hold other files, which
+ * the cache neither counts nor evicts. */
+static bool
+isEntry(const char *name)
+{
+    unsigned n = 0;
+
+    for (; '\0' != name[n]; ++n) {
+        char c = name[n];
+        if (!('0' <= c && c <= '9') && !('a' <= c && c <= 'f')) return false;
+    }
+    return 32 == n;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+Cache::Cache(const string &dir, uint64_t cap, const string &salt) :
+    _dir(dir), _salt(salt), _cap(cap), _used(0),
+    _hits(0), _misses(0), _stores(0), _evictions(0), _ntmp(0)
+{
+    struct stat sb;
+
+    if (-1 == mkdir(dir.c_str(), 0777) && EEXIST != errno) {
+        throw DFlowException(DFLOW_WHERE, why("cannot create", dir, errno));
+    }
+    DIR *d = opendir(dir.c_str());
+    if (NULL == d) {
+        throw DFlowException(DFLOW_WHERE, why("cannot open", dir, errno));
+    }
+    for (struct dirent *e = readdir(d); NULL != e; e = readdir(d)) {
+        if (!isEntry(e->d_name)) continue;
+        if (0 == stat(this->path(e->d_name).c_str(), &sb) &&
+            S_ISREG(sb.st_mode)) {
+            this->_used += sb.st_size;
+        }
+    }
+    closedir(d);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+string
+Cache::path(const string &key) const
+{
+    return this->_dir + "/" + key;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+string
+Cache::key(const char *data, size_t size) const
+{
+    static const char hex[] = "0123456789abcdef";
+    uint64_t a = 0, b = 0;
+    string out(32, '0');
+
+    hash128(this->_salt.data(), this->_salt.size(), a, b);
+    hash128(data, size, a, b);
+    for (unsigned i = 0; i < 16; ++i) {
+        out[15 - i] = hex[(a >> (4 * i)) & 0xf];
+        out[31 - i] = hex[(b >> (4 * i)) & 0xf];
+    }
+    return out;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+bool
+Cache::load(const string &key, string &text)
+{
+    const string p = this->path(key);
+    const size_t mlen = sizeof(MAGIC) - 1;
+    struct stat sb;
+    int fd = open(p.c_str(), O_RDONLY);
+
+    text.clear();
+    if (-1 != fd && 0 == fstat(fd, &sb)) {
+        text.resize(sb.st_size);
+        size_t got = 0;
+        while (got < text.size()) {
+            ssize_t n = read(fd, &text[got], text.size() - got);
+            if (0 == n || (-1 == n && EINTR != errno)) break;
+            if (0 < n) got += n;
+        }
+        text.resize(got);
+    }
+    if (-1 != fd) close(fd);
+    /* anything that is not a whole entry is a miss */
+    size_t nl = text.find('\n');
+    if (string::npos == nl || 0 != text.compare(0, mlen, MAGIC) ||
+        strtoull(text.c_str() + mlen, NULL, 10) != text.size() - nl - 1) {
+        ++this->_misses;
+        return false;
+    }
+    text.erase(0, nl + 1);
+    /* most recently used */
+    utimensat(AT_FDCWD, p.c_str(), NULL, 0);
+    ++this->_hits;
+    return true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Cache::store(const string &key, const string &text)
+{
+    const string tmp = this->path(".tmp-" + to_string(getpid()) + "-" +
+                                  to_string(this->_ntmp++));
+    const string p = this->path(key);
+    const string head = MAGIC + to_string(text.size()) + "\n";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    struct stat sb;
+
+    if (-1 == fd) return;
+    bool ok = writeAll(fd, head.data(), head.size()) &&
+              writeAll(fd, text.data(), text.size());
+    ok = (0 == close(fd)) && ok;
+    /* an entry this one replaces no longer counts */
+    uint64_t old = (0 == stat(p.c_str(), &sb)) ? sb.st_size : 0;
+    if (!ok || 0 != rename(tmp.c_str(), p.c_str())) {
+        unlink(tmp.c_str());
+        return;
+    }
+    ++this->_stores;
+    {
+        lock_guard<mutex> g(this->_lock);
+        this->_used -= min(this->_used, old);
+        this->_used += head.size() + text.size();
+    }
+    this->evict();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* rescans the directory, so it trims to three quarters of the cap to keep
+ * the next scan a while away */
+void
+Cache::evict(void)
+{
+    struct Entry {
+        struct timespec mtime;
+        uint64_t size;
+        string name;
+
+        bool operator<(const Entry &o) const {
+            return this->mtime.tv_sec < o.mtime.tv_sec ||
+                   (this->mtime.tv_sec == o.mtime.tv_sec &&
+                    this->mtime.tv_nsec < o.mtime.tv_nsec);
+        }
+    };
+    lock_guard<mutex> g(this->_lock);
+    vector<Entry> entries;
+    struct stat sb;
+
+    if (this->_used <= this->_cap) return;
+    DIR *d = opendir(this->_dir.c_str());
+    if (NULL == d) return;
+    this->_used = 0;
+    for (struct dirent *e = readdir(d); NULL != e; e = readdir(d)) {
+        if (!isEntry(e->d_name)) continue;
+        if (0 != stat(this->path(e->d_name).c_str(), &sb) ||
+            !S_ISREG(sb.st_mode)) {
+            continue;
+        }
+        Entry ent = {sb.st_mtim, uint64_t(sb.st_size), e->d_name};
+        entries.push_back(ent);
+        this->_used += sb.st_size;
+    }
+    closedir(d);
+    sort(entries.begin(), entries.end());
+    for (const Entry &e : entries) {
+        if (this->_used <= this->_cap / 4 * 3) break;
+        if (0 != unlink(this->path(e.name).c_str())) continue;
+        this->_used -= e.size;
+        ++this->_evictions;
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHE_H_INCLUDED
+#define CACHE_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+#include <stdint.h>
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* a directory of analysis results keyed by a hash of the source bytes and a
+ * salt naming everything else the results depend on (tool version, engine,
+ * analyses). entries are written to a temporary file and renamed into place,
+ * so readers and concurrent writers never see half an entry. hits refresh an
+ * entry's modification time, and once the directory grows past its cap the
+ * least recently used entries go first. */
+class Cache {
+private:
+    std::string _dir;
+    std::string _salt;
+    /* size cap and current size of the entries, in bytes */
+    uint64_t _cap, _used;
+    /* guards _used and eviction */
+    std::mutex _lock;
+    std::atomic<unsigned long> _hits, _misses, _stores, _evictions;
+    /* names temporary files */
+    std::atomic<unsigned long> _ntmp;
+
+    Cache(void);
+    Cache(const Cache &);
+    Cache &operator=(const Cache &);
+
+    std::string path(const std::string &key) const;
+    /* drops the oldest entries until the directory fits in its cap */
+    void evict(void);
+
+public:
+    /* creates dir if it does not exist */
+    Cache(const std::string &dir, uint64_t cap, const std::string &salt);
+
+    ~Cache(void) { ; }
+    /* 128-bit hash of data and the salt, in hex */
+    std::string key(const char *data, size_t size) const;
+    /* true and the entry in text on a hit */
+    bool load(const std::string &key, std::string &text);
+    /* best effort. a failed write only costs a future miss. */
+    void store(const std::string &key, const std::string &text);
+
+    unsigned long hits(void) const { return this->_hits; }
+
+    unsigned long misses(void) const { return this->_misses; }
+
+    unsigned long stores(void) const { return this->_stores; }
+
+    unsigned long evictions(void) const { return this->_evictions; }
+
+    const std::string &dir(void) const { return this->_dir; }
+};
+
+#endif
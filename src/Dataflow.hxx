@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATAFLOW_H_INCLUDED
+#define DATAFLOW_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "BitVector.hxx"
+#include "CFG.hxx"
+
+#include <vector>
+#include <queue>
+#include <functional>
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* generic monotone dataflow framework over the control flow graph. an
+ * analysis A supplies, all resolved at compile time:
+ *
+ *   static const DFDirection DIRECTION;
+ *   typedef DFUnion or DFIntersect Meet;
+ *   size_t width(void) const;                      bits per fact
+ *   void boundary(BitVector &b) const;             fact at entry (or exit)
+ *   void transfer(unsigned n, BitVector &x) const; node n, in place
+ */
+enum DFDirection {
+    DF_FORWARD = 0,
+    DF_BACKWARD
+};
+
+/* may analyses. the empty set is the identity. */
+struct DFUnion {
+    static void top(BitVector &b) { b.clear(); }
+
+    static void meet(BitVector &x, const BitVector &o) { x |= o; }
+};
+
+/* must analyses. the full set is the identity. */
+struct DFIntersect {
+    static void top(BitVector &b) { b.fill(); }
+
+    static void meet(BitVector &x, const BitVector &o) { x &= o; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* the control flow graph as facts flow through it */
+template <DFDirection D>
+struct DFView;
+
+template <>
+struct DFView<DF_FORWARD> {
+    const CFG &g;
+
+    DFView(const CFG &cfg) : g(cfg) { ; }
+
+    unsigned size(void) const { return g.size(); }
+
+    unsigned start(void) const { return g.entry(); }
+
+    unsigned nsuccs(unsigned n) const { return g.nsuccs(n); }
+
+    const unsigned *succs(unsigned n) const { return g.succs(n); }
+
+    unsigned npreds(unsigned n) const { return g.npreds(n); }
+
+    const unsigned *preds(unsigned n) const { return g.preds(n); }
+};
+
+template <>
+struct DFView<DF_BACKWARD> {
+    const CFG &g;
+
+    DFView(const CFG &cfg) : g(cfg) { ; }
+
+    unsigned size(void) const { return g.size(); }
+
+    unsigned start(void) const { return g.exit(); }
+
+    unsigned nsuccs(unsigned n) const { return g.npreds(n); }
+
+    const unsigned *succs(unsigned n) const { return g.preds(n); }
+
+    unsigned npreds(unsigned n) const { return g.nsuccs(n); }
+
+    const unsigned *preds(unsigned n) const { return g.succs(n); }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* worklist solver. nodes are visited lowest reverse postorder number (in the
+ * direction of flow) first, and only revisited when a flow predecessor
+ * changed. */
+template <typename A>
+class DFSolver {
+private:
+    typedef DFView<A::DIRECTION> View;
+    typedef typename A::Meet Meet;
+
+    const A &_a;
+    View _v;
+    /* facts before and after each node, in the direction of flow */
+    std::vector<BitVector> _before, _after;
+    std::vector<unsigned> _rpo, _order;
+    unsigned long _visits;
+
+    DFSolver(void);
+
+public:
+    DFSolver(const CFG &g, const A &a) : _a(a), _v(g), _visits(0) {
+        BitVector top(a.width());
+        Meet::top(top);
+        this->_before.assign(g.size(), top);
+        this->_after.assign(g.size(), top);
+        reversePostorder(this->_v, this->_v.start(), this->_order, this->_rpo);
+    }
+
+    ~DFSolver(void) { ; }
+
+    void solve(void) {
+        const View &v = this->_v;
+        /* keyed by reverse postorder number */
+        std::priority_queue<unsigned,
+                            std::vector<unsigned>,
+                            std::greater<unsigned> > work;
+        std::vector<bool> queued(this->_order.size(), true);
+        BitVector tmp(this->_a.width());
+
+        for (unsigned i = 0; i < this->_order.size(); ++i) work.push(i);
+
+        while (!work.empty()) {
+            unsigned n = this->_order[work.top()];
+            queued[work.top()] = false;
+            work.pop();
+            ++this->_visits;
+            /* meet */
+            if (v.start() == n) {
+                this->_a.boundary(tmp);
+            }
+            else {
+                Meet::top(tmp);
+                for (unsigned p = 0; p < v.npreds(n); ++p) {
+                    Meet::meet(tmp, this->_after[v.preds(n)[p]]);
+                }
+            }
+            this->_before[n] = tmp;
+            /* transfer */
+            this->_a.transfer(n, tmp);
+            if (tmp == this->_after[n]) continue;
+            this->_after[n] = tmp;
+            for (unsigned s = 0; s < v.nsuccs(n); ++s) {
+                unsigned r = this->_rpo[v.succs(n)[s]];
+                if (CFG::NONE != r && !queued[r]) {
+                    queued[r] = true;
+                    work.push(r);
+                }
+            }
+        }
+    }
+
+    unsigned long visits(void) const { return this->_visits; }
+    /* facts on entry to and exit from node n, in program order */
+    const BitVector &entry(unsigned n) const {
+        return DF_FORWARD == A::DIRECTION ? this->_before[n] : this->_after[n];
+    }
+
+    const BitVector &exit(unsigned n) const {
+        return DF_FORWARD == A::DIRECTION ? this->_after[n] : this->_before[n];
+    }
+};
+
+#endif
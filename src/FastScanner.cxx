@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FastScanner.hxx"
+#include "Program.hxx"
+#include "SourceParser.hh"
+
+#include <iostream>
+#include <string>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static inline bool
+isAlpha(unsigned char c)
+{
+    return unsigned((c | 0x20) - 'a') < 26;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static inline bool
+isDigit(unsigned char c)
+{
+    return unsigned(c - '0') < 10;
+}
+
+#ifdef __SSE2__
+/* ////////////////////////////////////////////////////////////////////////// */
+/* bytes of v in [lo, hi]. shifts the range down to start at -128 so one
+ * signed compare does it. */
+static inline __m128i
+inRange(__m128i v, unsigned char lo, unsigned char hi)
+{
+    __m128i s = _mm_add_epi8(v, _mm_set1_epi8(char(0x80 - lo)));
+    return _mm_cmplt_epi8(s, _mm_set1_epi8(char(-128 + (hi - lo + 1))));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static inline __m128i
+load(const char *p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+#endif
+
+/* ////////////////////////////////////////////////////////////////////////// */
+const char *
+FastScanner::skipSpace(const char *p, int &lineNo) const
+{
+#ifdef __SSE2__
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i nl = _mm_set1_epi8('\n');
+
+    for (; p + 16 <= this->_end; p += 16) {
+        __m128i v = load(p);
+        __m128i isnl = _mm_cmpeq_epi8(v, nl);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, sp),
+                                               _mm_cmpeq_epi8(v, tab)),
+                                  isnl);
+        unsigned wsm = _mm_movemask_epi8(ws);
+        unsigned nlm = _mm_movemask_epi8(isnl);
+        if (0xFFFF != wsm) {
+            unsigned k = __builtin_ctz(~wsm);
+            lineNo += __builtin_popcount(nlm & ((1U << k) - 1));
+            return p + k;
+        }
+        lineNo += __builtin_popcount(nlm);
+    }
+#endif
+    for (; p < this->_end; ++p) {
+        if ('\n' == *p) ++lineNo;
+        else if (' ' != *p && '\t' != *p) break;
+    }
+    return p;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+const char *
+FastScanner::skipAlpha(const char *p) const
+{
+#ifdef __SSE2__
+    /* setting bit 5 folds upper case onto lower case */
+    const __m128i fold = _mm_set1_epi8(0x20);
+
+    for (; p + 16 <= this->_end; p += 16) {
+        __m128i v = _mm_or_si128(load(p), fold);
+        unsigned m = _mm_movemask_epi8(inRange(v, 'a', 'z'));
+        if (0xFFFF != m) return p + __builtin_ctz(~m);
+    }
+#endif
+    while (p < this->_end && isAlpha(*p)) ++p;
+    return p;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+const char *
+FastScanner::skipDigits(const char *p) const
+{
+#ifdef __SSE2__
+    for (; p + 16 <= this->_end; p += 16) {
+        unsigned m = _mm_movemask_epi8(inRange(load(p), '0', '9'));
+        if (0xFFFF != m) return p + __builtin_ctz(~m);
+    }
+#endif
+    while (p < this->_end && isDigit(*p)) ++p;
+    return p;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static int
+keyword(const char *s, size_t len)
+{
+    switch (len) {
+        case 2:
+            if (0 == memcmp(s, "if", 2)) return IF;
+            if (0 == memcmp(s, "fi", 2)) return FI;
+            if (0 == memcmp(s, "do", 2)) return DO;
+            if (0 == memcmp(s, "od", 2)) return OD;
+            break;
+        case 4:
+            if (0 == memcmp(s, "then", 4)) return THEN;
+            if (0 == memcmp(s, "else", 4)) return ELSE;
+            if (0 == memcmp(s, "skip", 4)) return SKIP;
+            if (0 == memcmp(s, "true", 4)) return TRUE;
+            break;
+        case 5:
+            if (0 == memcmp(s, "while", 5)) return WHILE;
+            if (0 == memcmp(s, "false", 5)) return FALSE;
+            break;
+        default:
+            break;
+    }
+    return ID;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+FastScanner::next(Token &tok, int &lineNo)
+{
+    const char *p = this->skipSpace(this->_p, lineNo);
+    const char *b = p;
+    int code = 0;
+
+    if (p == this->_end) {
+        this->_p = p;
+        return 0;
+    }
+    if (isAlpha(*p)) {
+        p = this->skipAlpha(p + 1);
+        code = keyword(b, p - b);
+    }
+    else if (isDigit(*p)) {
+        p = this->skipDigits(p + 1);
+        code = INT;
+        if (p < this->_end && '.' == *p) {
+            p = this->skipDigits(p + 1);
+            code = FLOAT;
+        }
+    }
+    else {
+        bool eq = p + 1 < this->_end && '=' == p[1];
+        switch (*p++) {
+            case '+': code = OPPLUS; break;
+            case '-': code = OPMIN; break;
+            case '*': code = OPMUL; break;
+            case '/': code = OPDIV; break;
+            case ';': code = SEND; break;
+            case '!': code = NOT; break;
+            case '=':
+                if (eq) ++p;
+                code = eq ? EQ : ASSIGN;
+                break;
+            case '<':
+                if (eq) ++p;
+                code = eq ? LTE : LT;
+                break;
+            case '>':
+                if (eq) ++p;
+                code = eq ? GTE : GT;
+                break;
+            case '|':
+                if (p < this->_end && '|' == *p) {
+                    ++p;
+                    code = OR;
+                }
+                break;
+            case '&':
+                if (p < this->_end && '&' == *p) {
+                    ++p;
+                    code = AND;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    if (0 == code) {
+        /* same complaint as the flex scanner, and also stop there */
+        this->_err << "invalid token encountered during source scan: "
+                   << "\'" << string(b, 1) << "\'" << endl;
+        this->_p = this->_end;
+        return 0;
+    }
+    tok.text = b;
+    tok.len = p - b;
+    this->_p = p;
+    return code;
+}
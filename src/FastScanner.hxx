@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FAST_SCANNER_H_INCLUDED
+#define FAST_SCANNER_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ParseContext.hxx"
+
+#include <iostream>
+#include <cstddef>
+
+/* hand-written scanner for the same language as SourceScanner.ll, producing
+ * the same tokens. whitespace, identifiers and numbers are classified 16
+ * bytes at a time when SSE2 is available. */
+class FastScanner {
+private:
+    /* next unscanned byte */
+    const char *_p;
+    const char *_end;
+    /* where complaints about bad input go */
+    std::ostream &_err;
+
+    FastScanner(void);
+
+    const char *skipSpace(const char *p, int &lineNo) const;
+
+    const char *skipAlpha(const char *p) const;
+
+    const char *skipDigits(const char *p) const;
+
+public:
+    FastScanner(const char *buf, size_t len, std::ostream &err) :
+        _p(buf), _end(buf + len), _err(err) { ; }
+
+    ~FastScanner(void) { ; }
+    /* returns the next token's code, or 0 at the end of input. tok is set for
+     * identifiers and numbers. counts newlines into lineNo. */
+    int next(Token &tok, int &lineNo);
+};
+
+#endif
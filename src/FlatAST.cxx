@@ -0,0 +1,599 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FlatAST.hxx"
+#include "Base.hxx"
+#include "CFG.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+#include "Program.hxx"
+#include "ReachingDefs.hxx"
+
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+unsigned
+FlatAST::open(FlatKind kind, unsigned op, uint32_t arg, bool neg)
+{
+    unsigned i = this->_vkind.size();
+
+    this->_vkind.push_back(kind);
+    this->_vop.push_back(op);
+    this->_vnot.push_back(neg);
+    this->_varg.push_back(arg);
+    this->_vnext.push_back(i + 1);
+    /* the vectors may have moved */
+    this->_size = i + 1;
+    this->_kind = this->_vkind.data();
+    this->_op = this->_vop.data();
+    this->_not = this->_vnot.data();
+    this->_arg = this->_varg.data();
+    this->_next = this->_vnext.data();
+    return i;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* blocks nest their statements one deeper. an if or while test sits at the
+ * statement's own depth and its branches one deeper. */
+void
+FlatAST::depth(void)
+{
+    vector<unsigned> open;
+
+    this->_vdepth.assign(this->size(), 0);
+    this->_depth = this->_vdepth.data();
+    for (unsigned i = 0; i < this->size(); ++i) {
+        while (!open.empty() && this->_next[open.back()] <= i) open.pop_back();
+        if (!open.empty()) {
+            unsigned p = open.back();
+            unsigned d = this->_depth[p];
+            switch (this->_kind[p]) {
+                case FLAT_BLOCK:
+                    d += 1;
+                    break;
+                case FLAT_IF:
+                case FLAT_WHILE:
+                    if (i != p + 1) d += 1;
+                    break;
+                default:
+                    break;
+            }
+            this->_vdepth[i] = d;
+        }
+        open.push_back(i);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* every node but a block takes the next label in preorder. a block keeps the
+ * last label handed out before it. */
+void
+FlatAST::label(void)
+{
+    int label = 0;
+
+    this->_vlabel.resize(this->size());
+    this->_label = this->_vlabel.data();
+    for (unsigned i = 0; i < this->size(); ++i) {
+        this->_vlabel[i] = (FLAT_BLOCK == this->_kind[i]) ? label : ++label;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* expressions are at most a few nodes deep */
+void
+FlatAST::printExpr(Sink &out, unsigned i, const SymbolTable &syms) const
+{
+    bool neg = this->_not[i];
+    unsigned l = i + 1, r = l < this->size() ? this->_next[l] : l;
+
+    switch (this->_kind[i]) {
+        case FLAT_IDENT:
+            if (neg) out << '!';
+            out << syms.name(this->_arg[i]);
+            break;
+        case FLAT_INT:
+            out << int(this->_arg[i]);
+            break;
+        case FLAT_FLOAT: {
+            float f;
+            memcpy(&f, &this->_arg[i], sizeof(f));
+            out << Base::float2string(f);
+            break;
+        }
+        case FLAT_LOGICAL:
+            if (neg) out << '!';
+            out << (this->_arg[i] ? "true" : "false");
+            break;
+        case FLAT_ASSIGN:
+            this->printExpr(out, l, syms);
+            out << " = ";
+            this->printExpr(out, r, syms);
+            break;
+        case FLAT_ARITH:
+        case FLAT_LOGIC:
+            neg = neg && FLAT_LOGIC == this->_kind[i];
+            if (neg) out << "!(";
+            this->printExpr(out, l, syms);
+            out << ' ' << Expression::opstr(BinOp(this->_op[i])) << ' ';
+            this->printExpr(out, r, syms);
+            if (neg) out << ')';
+            break;
+        default:
+            break;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+FlatAST::print(Sink &out, bool a, const SymbolTable &syms) const
+{
+    vector<unsigned> open;
+
+    for (unsigned i = 0; i <= this->size(); ++i) {
+        /* close finished subtrees. block ends separate if and while parts. */
+        while (!open.empty() &&
+               (i == this->size() || this->_next[open.back()] <= i)) {
+            unsigned b = open.back();
+            open.pop_back();
+            if (FLAT_BLOCK != this->_kind[b] || open.empty()) continue;
+            unsigned p = open.back();
+            unsigned pad = this->_depth[p];
+            bool last = this->_next[b] == this->_next[p];
+            if (FLAT_IF == this->_kind[p]) {
+                if (b == p + 1) out << " then\n";
+                else if (!last) out.pad(pad) << "else\n";
+                else out.pad(pad) << "fi\n";
+            }
+            else if (FLAT_WHILE == this->_kind[p]) {
+                if (b == p + 1) out << " do\n";
+                else out.pad(pad) << "od\n";
+            }
+        }
+        if (i == this->size()) break;
+        switch (this->_kind[i]) {
+            case FLAT_BLOCK:
+                open.push_back(i);
+                break;
+            case FLAT_IF:
+                out.pad(this->_depth[i]) << "if ";
+                open.push_back(i);
+                break;
+            case FLAT_WHILE:
+                out.pad(this->_depth[i]) << "while ";
+                open.push_back(i);
+                break;
+            case FLAT_SKIP:
+                if (a) out.pad(this->_depth[i]) << '[';
+                out << "skip";
+                if (a) out << "] -- " << this->_label[i] << '\n';
+                break;
+            case FLAT_STMT:
+            case FLAT_TEST: {
+                bool test = FLAT_TEST == this->_kind[i];
+                if (a) out.pad(test ? 0 : this->_depth[i]) << '[';
+                this->printExpr(out, i + 1, syms);
+                if (a) out << "] -- " << this->_label[i];
+                if (!test) out << '\n';
+                /* the expression is done */
+                i = this->_next[i] - 1;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+string
+FlatAST::str(bool a, const SymbolTable &syms) const
+{
+    ostringstream os;
+    {
+        Sink out(os);
+        this->print(out, a, syms);
+    }
+    return os.str();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* the same graph Block::buildCFG makes, in one scan. an open if or while
+ * remembers its test node and, for an if, where the true branch ended. */
+void
+FlatAST::buildCFG(CFG &g)
+{
+    struct Frame {
+        unsigned p, test, ifOut;
+    };
+    vector<Frame> open;
+    unsigned n = g.newNode(CFG_ENTRY);
+    unsigned e = g.newNode(CFG_EXIT);
+    unsigned cur = n;
+
+    this->_cfgnode.assign(this->size(), CFG::NONE);
+    for (unsigned i = 0; i <= this->size(); ++i) {
+        while (!open.empty() &&
+               (i == this->size() || this->_next[open.back().p] <= i)) {
+            const Frame f = open.back();
+            open.pop_back();
+            unsigned merge = g.newNode(CFG_MERGE, this->_label[f.p]);
+            if (FLAT_IF == this->_kind[f.p]) {
+                g.newEdge(f.ifOut, merge);
+                g.newEdge(cur, merge);
+            }
+            else {
+                g.newEdge(cur, f.test);
+                g.newEdge(f.test, merge);
+            }
+            this->_cfgnode[f.p] = merge;
+            cur = merge;
+        }
+        if (i == this->size()) break;
+        switch (this->_kind[i]) {
+            case FLAT_STMT:
+            case FLAT_SKIP: {
+                unsigned s = g.newNode(CFG_STMT, this->_label[i]);
+                g.newEdge(cur, s);
+                this->_cfgnode[i] = cur = s;
+                i = this->_next[i] - 1;
+                break;
+            }
+            case FLAT_IF:
+            case FLAT_WHILE: {
+                /* i + 1 is the test block, i + 2 its only statement */
+                unsigned t = g.newNode(CFG_TEST, this->_label[i + 2]);
+                Frame f = {i, t, CFG::NONE};
+                g.newEdge(cur, t);
+                this->_cfgnode[i + 2] = cur = t;
+                open.push_back(f);
+                /* past the test */
+                i = this->_next[i + 1] - 1;
+                break;
+            }
+            case FLAT_BLOCK:
+                /* an else block starts over from the test */
+                if (!open.empty() && FLAT_IF == this->_kind[open.back().p] &&
+                    this->_next[i] == this->_next[open.back().p]) {
+                    open.back().ifOut = cur;
+                    cur = open.back().test;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    g.newEdge(cur, e);
+    g.finalize();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+FlatAST::rdcalc(ostream &os, const SymbolTable &syms, varid nvars)
+{
+    DefTable defs(nvars);
+    CFG g;
+
+    /* an assignment's definition is labeled by its statement */
+    for (unsigned i = 0; i < this->size(); ++i) {
+        if (FLAT_ASSIGN == this->_kind[i]) {
+            defs.add(this->_arg[i], this->_label[i - 1], NULL);
+        }
+    }
+    defs.seal();
+    this->buildCFG(g);
+    RDWorklist wl(g, defs);
+    wl.solve(defs.startSet());
+    os << "> -- done after " << wl.visits() << " node visits over "
+       << this->size() << " flat nodes ..." << endl;
+    os << "> -- here are the rd sets ..." << endl;
+
+    Sink out(os);
+    vector<unsigned> loops;
+    for (unsigned i = 0; i <= this->size(); ++i) {
+        /* a loop's exit set follows its body */
+        while (!loops.empty() &&
+               (i == this->size() || this->_next[loops.back()] <= i)) {
+            unsigned c = this->_cfgnode[loops.back()];
+            loops.pop_back();
+            Node::emitVLabSet(out, syms, defs.toMap(wl.out(c)));
+        }
+        if (i == this->size()) break;
+        FlatKind k = FlatKind(this->_kind[i]);
+        if (FLAT_WHILE == k) loops.push_back(i);
+        if (FLAT_STMT != k && FLAT_TEST != k && FLAT_SKIP != k) continue;
+        unsigned c = this->_cfgnode[i];
+        Node::emitVLabSet(out, syms, defs.toMap(wl.in(c)));
+        if (FLAT_SKIP == k) {
+            out << "skip\n";
+        }
+        else {
+            out << '[';
+            this->printExpr(out, i + 1, syms);
+            out << "] -- " << this->_label[i] << '\n';
+        }
+        Node::emitVLabSet(out, syms, defs.toMap(wl.out(c)));
+        i = this->_next[i] - 1;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+/* image sections, in file order */
+enum FlatSection {
+    SEC_KIND = 0,
+    SEC_OP,
+    SEC_NOT,
+    SEC_ARG,
+    SEC_NEXT,
+    SEC_DEPTH,
+    SEC_LABEL,
+    /* nvars + 1 offsets into SEC_NAMES */
+    SEC_NAMEOFF,
+    SEC_NAMES,
+    SEC_N
+};
+
+/* an image is this header followed by its sections. offsets count from the
+ * start of the image and are 8-byte aligned, so the arrays are usable right
+ * where the image is mapped. */
+struct FlatImage {
+    char magic[8];
+    uint32_t version;
+    /* 0x01020304 as the writer stored it */
+    uint32_t order;
+    uint32_t nnodes, nvars;
+    uint64_t off[SEC_N], len[SEC_N];
+    /* of the whole image */
+    uint64_t size;
+};
+
+static const char IMAGE_MAGIC[8] = {'D', 'F', 'L', 'O', 'W', 'A', 'S', 'T'};
+static const uint32_t IMAGE_VERSION = 1;
+static const uint32_t IMAGE_ORDER = 0x01020304;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static uint64_t
+align8(uint64_t n)
+{
+    return (n + 7) & ~uint64_t(7);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+FlatAST::save(ostream &os, const SymbolTable &syms) const
+{
+    static const char zeros[8] = {0};
+    const uint32_t n = this->size();
+    FlatImage h;
+    vector<uint32_t> nameoff(1, 0);
+    const void *data[SEC_N];
+
+    if (!this->_depth || !this->_label) {
+        throw DFlowException(DFLOW_WHERE, "saving an unlabeled flat tree");
+    }
+    for (varid v = 0; v < syms.size(); ++v) {
+        nameoff.push_back(nameoff.back() + syms.name(v).size());
+    }
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, IMAGE_MAGIC, sizeof(h.magic));
+    h.version = IMAGE_VERSION;
+    h.order = IMAGE_ORDER;
+    h.nnodes = n;
+    h.nvars = syms.size();
+    h.len[SEC_KIND] = h.len[SEC_OP] = h.len[SEC_NOT] = n;
+    h.len[SEC_ARG] = h.len[SEC_NEXT] = h.len[SEC_DEPTH] = 4 * uint64_t(n);
+    h.len[SEC_LABEL] = 4 * uint64_t(n);
+    h.len[SEC_NAMEOFF] = 4 * nameoff.size();
+    h.len[SEC_NAMES] = nameoff.back();
+    h.size = align8(sizeof(h));
+    for (unsigned s = 0; s < SEC_N; ++s) {
+        h.off[s] = h.size;
+        h.size = align8(h.size + h.len[s]);
+    }
+    data[SEC_KIND] = this->_kind;
+    data[SEC_OP] = this->_op;
+    data[SEC_NOT] = this->_not;
+    data[SEC_ARG] = this->_arg;
+    data[SEC_NEXT] = this->_next;
+    data[SEC_DEPTH] = this->_depth;
+    data[SEC_LABEL] = this->_label;
+    data[SEC_NAMEOFF] = nameoff.data();
+    data[SEC_NAMES] = NULL;
+
+    uint64_t at = sizeof(h);
+    os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    for (unsigned s = 0; s < SEC_N; ++s) {
+        os.write(zeros, h.off[s] - at);
+        if (SEC_NAMES == s) {
+            for (varid v = 0; v < syms.size(); ++v) os << syms.name(v);
+        }
+        else if (0 != h.len[s]) {
+            os.write(static_cast<const char *>(data[s]), h.len[s]);
+        }
+        at = h.off[s] + h.len[s];
+    }
+    os.write(zeros, h.size - at);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* checks everything a traversal relies on: sections in bounds, kinds,
+ * operators and variables in range, subtrees that nest, the shapes the
+ * grammar makes, and the depths and labels depth and label would assign. the
+ * scan touches each node once and allocates nothing per node. */
+void
+FlatAST::load(const char *data, size_t size, SymbolTable &syms)
+{
+    const FlatImage *h = reinterpret_cast<const FlatImage *>(data);
+    static const string bad = "not a flat AST image: ";
+
+    if (size < sizeof(*h)) {
+        throw DFlowException(DFLOW_WHERE, bad + "too short", false);
+    }
+    if (0 != memcmp(h->magic, IMAGE_MAGIC, 8)) {
+        throw DFlowException(DFLOW_WHERE, bad + "bad magic", false);
+    }
+    if (IMAGE_VERSION != h->version || IMAGE_ORDER != h->order) {
+        throw DFlowException(DFLOW_WHERE, bad + "other version or host",
+                             false);
+    }
+    if (0 != (reinterpret_cast<uintptr_t>(data) & 7) || h->size != size) {
+        throw DFlowException(DFLOW_WHERE, bad + "misaligned or truncated",
+                             false);
+    }
+    const uint64_t n = h->nnodes, nv = h->nvars;
+    const uint64_t want[SEC_N] = {n, n, n, 4 * n, 4 * n, 4 * n, 4 * n,
+                                  4 * (nv + 1), h->len[SEC_NAMES]};
+    for (unsigned s = 0; s < SEC_N; ++s) {
+        if (want[s] != h->len[s] || 0 != (h->off[s] & 7) ||
+            h->off[s] > size || h->len[s] > size - h->off[s]) {
+            throw DFlowException(DFLOW_WHERE, bad + "bad section", false);
+        }
+    }
+    const uint32_t *nameoff =
+        reinterpret_cast<const uint32_t *>(data + h->off[SEC_NAMEOFF]);
+    const char *names = data + h->off[SEC_NAMES];
+    if (0 != nameoff[0] || h->len[SEC_NAMES] != nameoff[nv]) {
+        throw DFlowException(DFLOW_WHERE, bad + "bad names", false);
+    }
+
+    this->_size = n;
+    this->_kind = reinterpret_cast<const uint8_t *>(data + h->off[SEC_KIND]);
+    this->_op = reinterpret_cast<const uint8_t *>(data + h->off[SEC_OP]);
+    this->_not = reinterpret_cast<const uint8_t *>(data + h->off[SEC_NOT]);
+    this->_arg = reinterpret_cast<const uint32_t *>(data + h->off[SEC_ARG]);
+    this->_next = reinterpret_cast<const uint32_t *>(data + h->off[SEC_NEXT]);
+    this->_depth =
+        reinterpret_cast<const uint32_t *>(data + h->off[SEC_DEPTH]);
+    this->_label =
+        reinterpret_cast<const int32_t *>(data + h->off[SEC_LABEL]);
+
+    /* the root is never closed before the end */
+    vector<unsigned> open(1, 0);
+    int label = 0;
+    bool ok = 0 < n && FLAT_BLOCK == this->_kind[0] && n == this->_next[0] &&
+              0 == this->_depth[0] && 0 == this->_label[0];
+    for (unsigned i = 1; ok && i < n; ++i) {
+        while (this->_next[open.back()] <= i) open.pop_back();
+        const unsigned p = open.back();
+        const FlatKind k = FlatKind(this->_kind[i]);
+        const FlatKind pk = FlatKind(this->_kind[p]);
+        const uint32_t e = this->_next[i];
+        /* depth and label would give i these */
+        const unsigned d = this->_depth[p] +
+            ((FLAT_BLOCK == pk ||
+              ((FLAT_IF == pk || FLAT_WHILE == pk) && i != p + 1)) ? 1 : 0);
+        if (FLAT_BLOCK != k) ++label;
+        ok = k < FLAT_NKINDS && e > i && e <= this->_next[p] &&
+             d == this->_depth[i] && label == this->_label[i];
+        /* what may sit under p */
+        switch (ok ? pk : FLAT_NKINDS) {
+            case FLAT_BLOCK:
+                /* an if or while test block holds just its test */
+                if (0 < p && (FLAT_IF == this->_kind[p - 1] ||
+                              FLAT_WHILE == this->_kind[p - 1])) {
+                    ok = FLAT_TEST == k && p + 1 == i &&
+                         e == this->_next[p];
+                }
+                else {
+                    ok = FLAT_STMT == k || FLAT_SKIP == k ||
+                         FLAT_IF == k || FLAT_WHILE == k;
+                }
+                break;
+            case FLAT_IF:
+            case FLAT_WHILE:
+                ok = FLAT_BLOCK == k;
+                break;
+            case FLAT_STMT:
+                ok = FLAT_ASSIGN == k;
+                break;
+            case FLAT_TEST:
+                ok = FLAT_ARITH <= k;
+                break;
+            case FLAT_ASSIGN:
+                ok = (p + 1 == i) ? FLAT_IDENT == k : FLAT_ARITH <= k;
+                break;
+            case FLAT_ARITH:
+            case FLAT_LOGIC:
+                /* operands are leaves, so expressions stay shallow */
+                ok = FLAT_IDENT <= k;
+                break;
+            default:
+                /* nothing else has children */
+                ok = false;
+                break;
+        }
+        /* what i holds */
+        switch (ok ? k : FLAT_NKINDS) {
+            case FLAT_IF:
+            case FLAT_WHILE: {
+                /* a test block, a body and, for an if, an else block */
+                uint32_t b = (i + 2 < e) ? this->_next[i + 1] : e;
+                ok = b < e && FLAT_TEST == this->_kind[i + 2] &&
+                     FLAT_BLOCK == this->_kind[b];
+                if (ok && FLAT_IF == k) {
+                    b = this->_next[b];
+                    ok = b < e && FLAT_BLOCK == this->_kind[b];
+                }
+                ok = ok && e == this->_next[b];
+                break;
+            }
+            case FLAT_STMT:
+            case FLAT_TEST:
+                ok = i + 1 < e && e == this->_next[i + 1];
+                break;
+            case FLAT_ASSIGN:
+                ok = this->_arg[i] < nv;
+                /* fall through */
+            case FLAT_ARITH:
+            case FLAT_LOGIC:
+                ok = ok && this->_op[i] < OP_NOPS && i + 1 < e &&
+                     this->_next[i + 1] < e &&
+                     e == this->_next[this->_next[i + 1]];
+                break;
+            case FLAT_IDENT:
+                ok = this->_arg[i] < nv;
+                /* fall through */
+            case FLAT_SKIP:
+            case FLAT_INT:
+            case FLAT_FLOAT:
+            case FLAT_LOGICAL:
+                ok = ok && e == i + 1;
+                break;
+            default:
+                break;
+        }
+        open.push_back(i);
+    }
+    for (uint64_t v = 0; ok && v < nv; ++v) {
+        ok = nameoff[v] <= nameoff[v + 1];
+    }
+    if (!ok) {
+        this->_size = 0;
+        throw DFlowException(DFLOW_WHERE, bad + "malformed tree", false);
+    }
+    /* ids must come out as they went in */
+    for (uint64_t v = 0; v < nv; ++v) {
+        if (v != syms.intern(names + nameoff[v], nameoff[v + 1] - nameoff[v])) {
+            this->_size = 0;
+            throw DFlowException(DFLOW_WHERE, bad + "duplicate names", false);
+        }
+    }
+}
@@ -0,0 +1,142 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLAT_AST_H_INCLUDED
+#define FLAT_AST_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "Sink.hxx"
+#include "SymbolTable.hxx"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+class CFG;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+enum FlatKind {
+    FLAT_BLOCK = 0,
+    /* assignment statement */
+    FLAT_STMT,
+    /* if or while test statement */
+    FLAT_TEST,
+    FLAT_SKIP,
+    FLAT_IF,
+    FLAT_WHILE,
+    FLAT_ASSIGN,
+    FLAT_ARITH,
+    FLAT_LOGIC,
+    FLAT_IDENT,
+    FLAT_INT,
+    FLAT_FLOAT,
+    FLAT_LOGICAL,
+    FLAT_NKINDS
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* a program as parallel arrays, one entry per node, in preorder. the children
+ * of node i start at i + 1 and its subtree ends just before next(i), so every
+ * traversal is a forward scan with a stack of open ancestors. depths, labels
+ * and analysis results live in side tables.
+ *
+ * the arrays are read through plain pointers. a tree built by flatten owns
+ * them; a tree loaded from an image points into the image, which the caller
+ * keeps alive. */
+class FlatAST {
+private:
+    unsigned _size;
+    const uint8_t *_kind;
+    /* BinOp of arithmetic and logical expressions */
+    const uint8_t *_op;
+    /* negated identifiers, logicals and logical expressions */
+    const uint8_t *_not;
+    /* variable, constant bits or truth value */
+    const uint32_t *_arg;
+    /* one past the last node of the subtree */
+    const uint32_t *_next;
+    /* side tables */
+    const uint32_t *_depth;
+    const int32_t *_label;
+    /* storage of built trees */
+    std::vector<uint8_t> _vkind, _vop, _vnot;
+    std::vector<uint32_t> _varg, _vnext, _vdepth;
+    std::vector<int32_t> _vlabel;
+    /* control flow graph node of statements, tests and loop exits */
+    std::vector<unsigned> _cfgnode;
+
+    FlatAST(const FlatAST &);
+    FlatAST &operator=(const FlatAST &);
+
+    void printExpr(Sink &out, unsigned i, const SymbolTable &syms) const;
+
+public:
+    FlatAST(void) :
+        _size(0), _kind(NULL), _op(NULL), _not(NULL), _arg(NULL),
+        _next(NULL), _depth(NULL), _label(NULL) { ; }
+
+    ~FlatAST(void) { ; }
+
+    /* appends a node whose children follow until the matching close */
+    unsigned open(FlatKind kind,
+                  unsigned op = 0,
+                  uint32_t arg = 0,
+                  bool neg = false);
+
+    void close(unsigned i) { this->_vnext[i] = this->_vkind.size(); }
+
+    void leaf(FlatKind kind, uint32_t arg = 0, bool neg = false) {
+        this->close(this->open(kind, 0, arg, neg));
+    }
+
+    unsigned size(void) const { return this->_size; }
+
+    FlatKind kind(unsigned i) const { return FlatKind(this->_kind[i]); }
+
+    unsigned next(unsigned i) const { return this->_next[i]; }
+
+    unsigned depth(unsigned i) const { return this->_depth[i]; }
+
+    int label(unsigned i) const { return this->_label[i]; }
+    /* fill the side tables the same way Node::depth and Node::label do */
+    void depth(void);
+
+    void label(void);
+
+    void print(Sink &out, bool a, const SymbolTable &syms) const;
+
+    std::string str(bool a, const SymbolTable &syms) const;
+    /* writes a depth-annotated, labeled tree and syms as an image load can
+     * use in place */
+    void save(std::ostream &os, const SymbolTable &syms) const;
+    /* points this tree at the image in data, which must stay put and be
+     * 8-byte aligned, and interns its names into the empty table syms.
+     * throws if the image is not one save wrote on this kind of host. */
+    void load(const char *data, size_t size, SymbolTable &syms);
+
+    void buildCFG(CFG &g);
+    /* worklist reaching definitions over variables [0, nvars). prints the
+     * sets like Block::rdcalc does. */
+    void rdcalc(std::ostream &os, const SymbolTable &syms, varid nvars);
+};
+
+#endif
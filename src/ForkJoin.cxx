@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ForkJoin.hxx"
+
+using namespace std;
+
+namespace {
+/* the scheduler the current thread is working for, its slot there, and how
+ * many forks are open on its call stack */
+struct Current {
+    ForkJoin *fj;
+    unsigned w;
+    unsigned nest;
+};
+
+thread_local Current current = {NULL, 0, 0};
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+ForkJoin::ForkJoin(unsigned nworkers, size_t threshold) :
+    _threshold(threshold), _stop(false), _pending(0), _spawned(0), _inlined(0)
+{
+    if (0 == nworkers) nworkers = 1;
+    for (unsigned i = 0; i < nworkers; ++i) {
+        this->_workers.push_back(unique_ptr<Worker>(new Worker()));
+    }
+    for (unsigned i = 1; i < nworkers; ++i) {
+        this->_threads.push_back(thread(&ForkJoin::work, this, i));
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+ForkJoin::~ForkJoin(void)
+{
+    this->_stop = true;
+    {
+        lock_guard<mutex> g(this->_idleLock);
+    }
+    this->_idle.notify_all();
+    for (auto &t : this->_threads) t.join();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ForkJoin::push(unsigned w, Task *t)
+{
+    {
+        lock_guard<mutex> g(this->_workers[w]->lock);
+        this->_workers[w]->tasks.push_back(t);
+    }
+    ++this->_pending;
+    /* taking the lock orders this against a worker about to sleep */
+    {
+        lock_guard<mutex> g(this->_idleLock);
+    }
+    this->_idle.notify_one();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+ForkJoin::Task *
+ForkJoin::pop(unsigned w)
+{
+    Worker &me = *this->_workers[w];
+    lock_guard<mutex> g(me.lock);
+    if (me.tasks.empty()) return NULL;
+    Task *t = me.tasks.back();
+    me.tasks.pop_back();
+    --this->_pending;
+    return t;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* takes the oldest task of the first busy worker after w. old tasks sit
+ * highest in the fork tree, so they tend to carry the most work. */
+ForkJoin::Task *
+ForkJoin::steal(unsigned w)
+{
+    const unsigned n = this->_workers.size();
+
+    for (unsigned i = 1; i < n; ++i) {
+        Worker &v = *this->_workers[(w + i) % n];
+        lock_guard<mutex> g(v.lock);
+        if (v.tasks.empty()) continue;
+        Task *t = v.tasks.front();
+        v.tasks.pop_front();
+        --this->_pending;
+        return t;
+    }
+    return NULL;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ForkJoin::exec(Task *t)
+{
+    try {
+        (*t->fn)();
+    }
+    catch (...) {
+        t->error = current_exception();
+    }
+    t->done = true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ForkJoin::work(unsigned w)
+{
+    current.fj = this;
+    current.w = w;
+    while (!this->_stop) {
+        Task *t = this->steal(w);
+        if (t) {
+            exec(t);
+            continue;
+        }
+        unique_lock<mutex> g(this->_idleLock);
+        this->_idle.wait(g, [this] {
+            return this->_stop || this->_pending > 0;
+        });
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ForkJoin::run(const function<void(void)> &root)
+{
+    Current saved = current;
+
+    current.fj = this;
+    current.w = 0;
+    try {
+        root();
+    }
+    catch (...) {
+        current = saved;
+        throw;
+    }
+    current = saved;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* b is offered to thieves while a runs here. whatever a forked has been
+ * joined by the time it returns, so b is on top of our deque unless it was
+ * stolen; while a thief has it, we help with other work. */
+void
+ForkJoin::fork(unsigned w,
+               const function<void(void)> &a,
+               const function<void(void)> &b)
+{
+    Task tb(&b);
+
+    this->push(w, &tb);
+    ++this->_spawned;
+    ++current.nest;
+    exception_ptr aerror;
+    try {
+        a();
+    }
+    catch (...) {
+        aerror = current_exception();
+    }
+    while (!tb.done) {
+        Task *t = this->pop(w);
+        if (!t) t = this->steal(w);
+        if (t) exec(t);
+        else this_thread::yield();
+    }
+    --current.nest;
+    if (aerror) rethrow_exception(aerror);
+    if (tb.error) rethrow_exception(tb.error);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ForkJoin::invoke(size_t weight,
+                 const function<void(void)> &a,
+                 const function<void(void)> &b)
+{
+    if (ForkJoin::tryInvoke(weight, a, b)) return;
+    a();
+    b();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+bool
+ForkJoin::tryInvoke(size_t weight,
+                    const function<void(void)> &a,
+                    const function<void(void)> &b)
+{
+    ForkJoin *fj = current.fj;
+
+    if (fj && fj->size() > 1 && weight >= fj->_threshold &&
+        current.nest < ForkJoin::MAXNEST) {
+        fj->fork(current.w, a, b);
+        return true;
+    }
+    if (fj) ++fj->_inlined;
+    return false;
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FORK_JOIN_H_INCLUDED
+#define FORK_JOIN_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <stddef.h>
+
+/* work-stealing fork-join scheduler. the thread that calls run is worker 0;
+ * the rest are started by the constructor. each worker forks onto the back of
+ * its own deque and takes work back from there; idle workers steal from the
+ * front of the others'. */
+class ForkJoin {
+private:
+    struct Task {
+        const std::function<void(void)> *fn;
+        std::atomic<bool> done;
+        std::exception_ptr error;
+
+        Task(const std::function<void(void)> *f) : fn(f), done(false) { ; }
+    };
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task *> tasks;
+    };
+
+    /* forks nested deeper than this on one thread run inline, so a deep tree
+     * can't pile fork frames onto a worker's call stack */
+    static const unsigned MAXNEST = 64;
+    /* forks lighter than this run inline */
+    size_t _threshold;
+    std::vector<std::unique_ptr<Worker> > _workers;
+    std::vector<std::thread> _threads;
+    std::atomic<bool> _stop;
+    /* tasks sitting in some deque */
+    std::atomic<long> _pending;
+    std::mutex _idleLock;
+    std::condition_variable _idle;
+    std::atomic<unsigned long> _spawned, _inlined;
+
+    ForkJoin(void);
+    ForkJoin(const ForkJoin &);
+    ForkJoin &operator=(const ForkJoin &);
+
+    void push(unsigned w, Task *t);
+
+    Task *pop(unsigned w);
+
+    Task *steal(unsigned w);
+
+    static void exec(Task *t);
+
+    void work(unsigned w);
+
+    void fork(unsigned w,
+              const std::function<void(void)> &a,
+              const std::function<void(void)> &b);
+
+public:
+    ForkJoin(unsigned nworkers, size_t threshold);
+    /* joins the workers. must not be called from inside run. */
+    ~ForkJoin(void);
+    /* runs root on the calling thread with the workers helping */
+    void run(const std::function<void(void)> &root);
+    /* runs a and b, in parallel if the calling thread is inside a run and
+     * weight is at least the threshold. returns once both are done. */
+    static void invoke(size_t weight,
+                       const std::function<void(void)> &a,
+                       const std::function<void(void)> &b);
+    /* like invoke, but only if it would fork. otherwise runs neither, counts
+     * an inlined fork and returns false, and the caller runs a and b its own
+     * way. */
+    static bool tryInvoke(size_t weight,
+                          const std::function<void(void)> &a,
+                          const std::function<void(void)> &b);
+
+    unsigned size(void) const { return this->_workers.size(); }
+
+    unsigned long spawned(void) const { return this->_spawned; }
+
+    unsigned long inlined(void) const { return this->_inlined; }
+};
+
+#endif
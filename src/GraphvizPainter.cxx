@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GraphvizPainter.hxx"
+#include "Base.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+
+#include <string>
+#include <cstdio>
+#include <mutex>
+
+#include <string.h>
+#include <errno.h>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static mutex &
+gvlock(void)
+{
+    static mutex m;
+    return m;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* one graphviz context for the whole process. loading the layout and render
+ * plugins is the expensive part, so it is only done once. */
+static GVC_t *
+context(void)
+{
+    static struct Context {
+        GVC_t *gvc;
+        Context(void) : gvc(gvContext()) { ; }
+        ~Context(void) { gvFreeContext(this->gvc); }
+    } c;
+    return c.gvc;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+GraphvizPainter::GraphvizPainter(string prefix, string type) :
+    Painter(prefix, type)
+{
+    lock_guard<mutex> g(gvlock());
+    /* prep graph so nodes and edges can be added later */
+    this->graph = agopen((char *)"ast", Agdirected, 0);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+GraphvizPainter::~GraphvizPainter(void)
+{
+    lock_guard<mutex> g(gvlock());
+    agclose(this->graph);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+GraphvizPainter::node(PNode n, const string &label)
+{
+    string name = "__0xdFl0wX0__" + Base::int2string(n);
+    lock_guard<mutex> g(gvlock());
+    Agnode_t *an = agnode(this->graph, (char *)name.c_str(), 1);
+    agsafeset(an, (char *)"label", (char *)label.c_str(), (char *)"");
+    this->nodes.push_back(an);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+GraphvizPainter::edge(PNode n1, PNode n2)
+{
+    lock_guard<mutex> g(gvlock());
+    agedge(this->graph, this->nodes[n1], this->nodes[n2], (char *)"", 1);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+GraphvizPainter::renderAST(void)
+{
+    lock_guard<mutex> g(gvlock());
+    /* first write the dot files */
+    FILE *fp = NULL;
+    string fullnam = this->fprefix + ".dot";
+
+    if (NULL == (fp = fopen(fullnam.c_str(), "w+"))) {
+        int err = errno;
+        string estr = "cannot open: " + fullnam + ". why: " +
+                      strerror(err) + ".";
+        throw DFlowException(DFLOW_WHERE, estr);
+    }
+    agwrite(this->graph, fp);
+    fclose(fp);
+
+    GVC_t *gvc = context();
+    string target = this->target();
+    if (0 != gvLayout(gvc, this->graph, "dot")) {
+        string estr = "\ncrud... laying out " + fullnam + " failed.";
+        throw DFlowException(DFLOW_WHERE, estr);
+    }
+    int rc = gvRenderFilename(gvc, this->graph, this->ftype.c_str(),
+                              target.c_str());
+    gvFreeLayout(gvc, this->graph);
+    if (0 != rc) {
+        string estr = "\ncrud... rendering " + target + " failed. try " +
+                      "using dot on " + fullnam;
+        throw DFlowException(DFLOW_WHERE, estr);
+    }
+}
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GRAPHVIZ_PAINTER_H_INCLUDED
+#define GRAPHVIZ_PAINTER_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "Painter.hxx"
+
+#include <string>
+#include <vector>
+
+#ifdef HAVE_CGRAPH_H
+#include "cgraph.h"
+#include "gvc.h"
+#elif defined HAVE_GRAPHVIZ_CGRAPH_H
+#include "graphviz/cgraph.h"
+#include "graphviz/gvc.h"
+#else
+#error "graphviz development packages are required."
+#endif
+
+/* builds a cgraph graph, then lays it out and renders it with libgvc.
+ * graphviz is not thread-safe, so every call into it is serialized. */
+class GraphvizPainter : public Painter {
+private:
+    /* graph */
+    Agraph_t *graph;
+    /* PNode -> graph node */
+    std::vector<Agnode_t *> nodes;
+
+    GraphvizPainter(void);
+
+protected:
+    virtual void node(PNode n, const std::string &label);
+
+    virtual void edge(PNode n1, PNode n2);
+
+public:
+    GraphvizPainter(std::string prefix, std::string type);
+
+    virtual ~GraphvizPainter(void);
+    /* writes prefix.dot, then lays out and renders prefix.type in process */
+    virtual void renderAST(void);
+};
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Options.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* new engines and scanners only need a line here */
+static const struct {
+    const char *name;
+    RDEngine rde;
+} rdEngineNames[] = {
+    {"map", RD_ENGINE_MAP},
+    {"bitvec", RD_ENGINE_BITVEC},
+    {"worklist", RD_ENGINE_WORKLIST},
+    {"bblock", RD_ENGINE_BBLOCK},
+    {"region", RD_ENGINE_REGION},
+    {"parallel", RD_ENGINE_PARALLEL},
+    {"dataflow", RD_ENGINE_DATAFLOW},
+    {"flat", RD_ENGINE_FLAT},
+    {"ssa", RD_ENGINE_SSA}
+};
+
+static const struct {
+    const char *name;
+    ScanEngine se;
+} scanEngineNames[] = {
+    {"fast", SCAN_FAST},
+    {"flex", SCAN_FLEX}
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+RDEngine
+Options::rdEngine(const string &name)
+{
+    for (const auto &e : rdEngineNames) {
+        if (name == e.name) return e.rde;
+    }
+    throw DFlowException(DFLOW_WHERE, "unknown rd engine: " + name, false);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+string
+Options::rdEngines(void)
+{
+    string names;
+
+    for (const auto &e : rdEngineNames) {
+        names += (names.empty() ? "" : "|") + string(e.name);
+    }
+    return names;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+ScanEngine
+Options::scanEngine(const string &name)
+{
+    for (const auto &e : scanEngineNames) {
+        if (name == e.name) return e.se;
+    }
+    throw DFlowException(DFLOW_WHERE, "unknown scanner: " + name, false);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+string
+Options::scanEngines(void)
+{
+    string names;
+
+    for (const auto &e : scanEngineNames) {
+        names += (names.empty() ? "" : "|") + string(e.name);
+    }
+    return names;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* control bytes are not allowed raw */
+string
+Options::quote(const string &s)
+{
+    static const char hex[] = "0123456789abcdef";
+    string q = "\"";
+
+    for (char c : s) {
+        unsigned char u = c;
+        if ('"' == c || '\\' == c) q += '\\';
+        if ('\n' == c) {
+            q += "\\n";
+            continue;
+        }
+        if (u < 0x20) {
+            q += "\\u00";
+            q += hex[u >> 4];
+            q += hex[u & 0xf];
+            continue;
+        }
+        q += c;
+    }
+    return q + "\"";
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+bool
+Options::number(const char *s, unsigned long long max, unsigned long long &n)
+{
+    char *end = NULL;
+
+    /* strtoull skips blanks and takes a sign, wrapping -1 around */
+    if (!isdigit(static_cast<unsigned char>(*s))) return false;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (0 != errno || '\0' != *end || v > max) return false;
+    n = v;
+    return true;
+}
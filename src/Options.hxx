@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPTIONS_H_INCLUDED
+#define OPTIONS_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "ParseContext.hxx"
+#include "Program.hxx"
+
+#include <string>
+#include <vector>
+#include <limits>
+
+#include <stddef.h>
+
+class Cache;
+
+/* what the command line tools share: the names engines and scanners go by,
+ * and how their json output quotes text. Settings below is what they are
+ * set to. */
+class Options {
+private:
+    Options(void);
+    ~Options(void);
+
+public:
+    /* most threads or jobs a count option may ask for */
+    static const unsigned MAXTHREADS = 1024;
+    /* throws on a name rdEngines does not list */
+    static RDEngine rdEngine(const std::string &name);
+    /* every rd engine name, separated by | */
+    static std::string rdEngines(void);
+
+    static ScanEngine scanEngine(const std::string &name);
+
+    static std::string scanEngines(void);
+    /* json string literal */
+    static std::string quote(const std::string &s);
+    /* a whole decimal number no larger than max. false, leaving n alone, on
+     * anything else: no digits, a sign, trailing junk or overflow. */
+    static bool number(const char *s,
+                       unsigned long long max,
+                       unsigned long long &n);
+
+    template <typename T>
+    static bool number(const char *s,
+                       T &n,
+                       unsigned long long max =
+                           std::numeric_limits<T>::max()) {
+        unsigned long long v;
+
+        if (!Options::number(s, max, v)) return false;
+        n = static_cast<T>(v);
+        return true;
+    }
+};
+
+/* how every input is analyzed */
+struct Settings {
+    RDEngine rde;
+    /* solver threads */
+    unsigned rdthreads;
+    /* smallest if branch, in labels, worth handing to another thread */
+    size_t forkmin;
+    ScanEngine se;
+    /* diagram output format. empty means no diagrams. */
+    std::string draw;
+    /* run after reaching definitions, in order */
+    std::vector<DFAnalysis> analyses;
+    /* where finished outputs are kept across runs. NULL means no cache. */
+    Cache *cache;
+    /* write each labeled program next to its input as an image */
+    bool emitAst;
+    /* inputs are images, not sources */
+    bool loadAst;
+
+    Settings(void) :
+        rde(RD_ENGINE_MAP), rdthreads(1), forkmin(64), se(SCAN_FAST),
+        cache(NULL), emitAst(false), loadAst(false) { ; }
+};
+
+#endif
@@ -15,123 +15,40 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "Base.hxx"
-#include "Constants.hxx"
-#include "DFlowException.hxx"
-
-#include <string>
-#include <iostream>
-#include <fstream>
-#include <cstdio>
-#include <algorithm>
-#include <sstream>
-
-#include <string.h>
-#include <ctype.h>
-#include <errno.h>
-
 #include "Painter.hxx"
-
-#define ARGC 3
-#define MAX_LEN 4096
+#include "GraphvizPainter.hxx"
+#include "StreamPainter.hxx"
 
 using namespace std;
 
 /* ////////////////////////////////////////////////////////////////////////// */
-Painter::Painter(string prefix, string type)
-{
-#if 0 /* only needed when using GVC and such */
-    string ftype = "-T" + type;
-    string fname = "-o" + prefix + "." + type;
-
-    /* fake an argv with our settings */
-    this->config = (char **)calloc(ARGC + 1, sizeof(char *));
-    this->config[ARGC] = (char *)NULL;
-    for (unsigned i = 0; i < ARGC; ++i) {
-        this->config[i] = (char *)calloc(MAX_LEN, sizeof(char));
-    }
-    strncpy(this->config[0], (char *)"dot", MAX_LEN - 1);
-    strncpy(this->config[1], (char *)ftype.c_str(), MAX_LEN - 1);
-    strncpy(this->config[2], (char *)fname.c_str(), MAX_LEN - 1);
-    /* set up a graphviz context */
-    this->gvc = gvContext();
-    /* set output and layout engine */
-    gvParseArgs(this->gvc, ARGC, this->config);
-#endif
-    this->ftype = type;
-    this->fprefix = prefix;
-    /* prep graph so nodes and edges can be added later */
-    this->graph = agopen((char *)"ast", Agdirected, 0);
-    /* used to generate uniq ids */
-    this->id = 0;
-}
-
-/* ////////////////////////////////////////////////////////////////////////// */
-Painter::~Painter(void)
+Painter *
+Painter::create(string prefix, string type)
 {
-    //gvFreeLayout(gvc, graph);
-    agclose(graph);
-    //gvFreeContext(gvc);
-
-#if 0
-    if (this->config) {
-        for (unsigned i = 0; i < ARGC; ++i) {
-            if (this->config[i]) free(this->config[i]);
-        }
-        free(this->config);
+    if ("dot" == type) {
+        return new StreamPainter(prefix, type, StreamPainter::DOT);
     }
-#endif
-}
-
-/* ////////////////////////////////////////////////////////////////////////// */
-void
-Painter::renderAST(void)
-{
-#if 0
-    gvLayoutJobs(gvc, graph);
-    gvRenderJobs(gvc, graph);
-#endif 
-    /* first write the dot files */
-    FILE *fp = NULL;
-    string fullnam = this->fprefix + ".dot";
-
-    if (NULL == (fp = fopen(fullnam.c_str(), "w+"))) {
-        int err = errno;
-        string estr = "cannot open: " + fullnam + ". why: " +
-                      strerror(err) + ".";
-        throw DFlowException(DFLOW_WHERE, estr);
+    if ("json" == type) {
+        return new StreamPainter(prefix, type, StreamPainter::JSON);
     }
-    agwrite(this->graph, fp);
-
-    std::string cmd = "dot -T" + this->ftype + " -o" + this->fprefix +
-                      "." + this->ftype + " " + fullnam;
-
-    if (0 != system(cmd.c_str())) {
-        string estr = "\ncrud... \"" + cmd + "\" failed. try using dot on " +
-                      fullnam;
-        throw DFlowException(DFLOW_WHERE, estr);
+    if ("graphml" == type) {
+        return new StreamPainter(prefix, type, StreamPainter::GRAPHML);
     }
+    return new GraphvizPainter(prefix, type);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
 PNode
-Painter::newNode(Painter *p, string label, int i)
-{
-    PNode newNode =  agnode(p->graph, (char *)Painter::uniqID(p).c_str(), i);
-    agsafeset(newNode, (char *)"label", (char *)label.c_str(), (char *)"");
-    return newNode;
-}
-
-/* ////////////////////////////////////////////////////////////////////////// */
-PEdge
-Painter::newEdge(Painter *p, PNode n1, PNode n2, string name, int j)
+Painter::newNode(Painter *p, const string &label)
 {
-    return agedge(p->graph, n1, n2, (char *)name.c_str(), j);
+    PNode n = p->id++;
+    p->node(n, label);
+    return n;
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
-string
-Painter::uniqID(Painter *p)
+void
+Painter::newEdge(Painter *p, PNode n1, PNode n2)
 {
-    return "__0xdFl0wX0__" + Base::int2string(p->id++);
+    p->edge(n1, n2);
 }
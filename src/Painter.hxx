@@ -3,7 +3,6 @@
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
-
  * the Free Software Foundation, either version 3 of the License, or
  * (at your option) any later version.
  *
@@ -24,52 +23,41 @@
 #endif
 
 #include <string>
-#include <iostream>
-
-#ifdef HAVE_CGRAPH_H
-#include "cgraph.h"
-#elif defined HAVE_GRAPHVIZ_CGRAPH_H
-#include "graphviz/cgraph.h"
-#else
-#error "graphviz development packages are required."
-#endif
-
-#if 0 /* gvc stuff */
-#include "gvc.h"
-#endif
 
-typedef Agnode_t* PNode;
-typedef Agedge_t* PEdge;
+/* diagram nodes are numbered densely in creation order */
+typedef unsigned PNode;
 
+/* where buildAST and drawCFG send their nodes and edges. backends either
+ * keep the whole graph for layout or stream it out as it is built. */
 class Painter {
-private:
-    int id;
+protected:
+    PNode id;
     std::string ftype;
     std::string fprefix;
-    /* graph */
-    Agraph_t *graph;
-#if 0 /* gvc stuff */
-    /* context */
-    GVC_t *gvc;
-    /* config argv */
-    char **config;
-#endif
 
-    Painter(void) { ; }
+    Painter(std::string prefix, std::string type) :
+        id(0), ftype(type), fprefix(prefix) { ; }
 
-public:
-    Painter(std::string prefix, std::string type);
+    virtual void node(PNode n, const std::string &label) = 0;
 
-    ~Painter(void);
+    virtual void edge(PNode n1, PNode n2) = 0;
+
+public:
+    /* dot, json and graphml are streamed straight to prefix.type. anything
+     * else is laid out and rendered by graphviz. */
+    static Painter *create(std::string prefix, std::string type);
 
-    static PNode newNode(Painter *p, std::string label, int i);
+    virtual ~Painter(void) { ; }
 
-    static PEdge newEdge(Painter *p, PNode n1, PNode n2,
-                         std::string name, int j);
+    static PNode newNode(Painter *p, const std::string &label);
 
-    void renderAST(void);
+    static void newEdge(Painter *p, PNode n1, PNode n2);
+    /* finish the output file. may be called from another thread. */
+    virtual void renderAST(void) = 0;
 
-    static std::string uniqID(Painter *p);
+    std::string target(void) const {
+        return this->fprefix + "." + this->ftype;
+    }
 };
 
 #endif
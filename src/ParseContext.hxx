@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARSE_CONTEXT_H_INCLUDED
+#define PARSE_CONTEXT_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "Arena.hxx"
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+class AssignmentExpression;
+class Block;
+class FastScanner;
+class SymbolTable;
+
+/* source scanners */
+enum ScanEngine {
+    /* the flex scanner. the reference implementation. */
+    SCAN_FLEX = 0,
+    /* hand-written, vectorized where the target allows */
+    SCAN_FAST
+};
+
+/* token text. points into the input buffer, so it is only good while the
+ * buffer is. */
+struct Token {
+    const char *text;
+    unsigned len;
+};
+
+/* everything one parse needs. the scanner and parser keep no state of their
+ * own, so parses with different contexts can run at the same time. */
+struct ParseContext {
+    /* owns everything built during the parse, including token strings */
+    Arena *arena;
+    /* variable names are interned here as they are parsed */
+    SymbolTable *syms;
+    /* top-level program block. set by a successful parse. */
+    Block *root;
+    /* every assignment parsed so far. handed to root at the end. */
+    std::vector<AssignmentExpression *> defsites;
+    /* input line number used for nice error messages */
+    int lineNo;
+    /* where parse errors and scanner complaints go */
+    std::ostream *out;
+    std::ostream *err;
+    /* which scanner to use */
+    ScanEngine scan;
+    /* state of the scanner in use */
+    void *flex;
+    FastScanner *fast;
+
+    ParseContext(Arena *a, SymbolTable *s, ScanEngine se = SCAN_FAST) :
+        arena(a), syms(s), root(NULL), lineNo(1), out(&std::cout),
+        err(&std::cerr), scan(se), flex(NULL), fast(NULL) { ; }
+
+    template <typename T, typename... Args>
+    T *make(Args &&...args) {
+        return this->arena->make<T>(std::forward<Args>(args)...);
+    }
+};
+
+/* parses the len bytes at buf. buf must be writable and buf[len] and
+ * buf[len + 1] must be zero -- the scanner works in place. returns 0 on
+ * success. */
+int
+parserParse(char *buf, size_t len, ParseContext &ctx);
+
+#endif
@@ -18,126 +18,174 @@
 #include "Program.hxx"
 #include "Base.hxx"
 #include "Painter.hxx"
+#include "ReachingDefs.hxx"
+#include "ForkJoin.hxx"
+#include "Analyses.hxx"
+#include "SSA.hxx"
+#include "Stats.hxx"
 
 #include <iostream>
 #include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <memory>
+#include <functional>
 
 using namespace std;
 
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
-const string Node::BOGUS_VAR = "_0xBoGuSx0_";
-vset
-Node::getvs(void)
+string
+Node::str(bool a) const
 {
-    vset n;
-    if (this->l) {
-        vset t = this->l->getvs();
-        n.insert(t.begin(), t.end());
-    }
-    if (this->r) {
-        vset t = this->r->getvs();
-        n.insert(t.begin(), t.end());
+    ostringstream os;
+    {
+        Sink out(os);
+        this->print(out, a);
     }
-    return n;
+    return os.str();
 }
 
 void
-Node::varclean(void)
+Node::emitVLabSet(Sink &out, const SymbolTable &syms, const vlabmap &s)
 {
-    auto it = this->_vars.find(Node::BOGUS_VAR);
-    if (it != this->_vars.end()) this->_vars.erase(it);
+    /* sets are ordered by id. print them in name order. */
+    vector<pair<varid, int> > byname(s.begin(), s.end());
+    stable_sort(byname.begin(), byname.end(),
+                [&syms](const pair<varid, int> &a, const pair<varid, int> &b) {
+                    return syms.rank(a.first) < syms.rank(b.first);
+                });
+    out << "{";
+    for (const auto &i : byname) {
+        out << " (" << syms.name(i.first) << ", ";
+        if (-1 == i.second) {
+            out << '?';
+        }
+        else {
+            out << i.second;
+        }
+        out << ')';
+    }
+    out << " }\n";
 }
 
 void
-Node::emitVars(void) const
+Node::emitVars(ostream &os, const SymbolTable &syms, varid nvars)
 {
+    /* names in sorted order */
+    vector<const string *> byname(nvars);
+    for (varid v = 0; v < nvars; ++v) {
+        byname[syms.rank(v)] = &syms.name(v);
+    }
     string out = "{";
-    for (const auto &v : this->_vars) {
-        out += " " + v;
+    for (const string *n : byname) {
+        out += " " + *n;
     }
     out += " }";
-    cout << out << endl;
-}
-
-vlabmap
-Node::genStartSet(void) const
-{
-    vlabmap ret;
-    for (const auto &v : this->_vars) {
-        ret.insert(make_pair(v, -1));
-    }
-    return ret;
+    os << out << endl;
 }
 
 void
-Node::emitVLabSet(const vlabmap &s)
+Node::dflocals(DFLocals &f) const
 {
-    cout << "{";
-    for (const auto &i : s) {
-        cout << " (" << i.first << ", ";
-        if (-1 == i.second) {
-            cout << "?";
-        }
-        else {
-            cout << i.second;
-        }
-        cout << ")";
-    }
-    cout << " }" << endl;
+    if (this->l) this->l->dflocals(f);
+    if (this->r) this->r->dflocals(f);
 }
 
 bool
 Node::rdgo(const vlabmap &in, vlabmap &out)
 {
+    Stats::count(STAT_VISIT_NODE);
+    Stats::count(STAT_SET_COPIES, 3);
     this->_entry = this->_exit = in;
     out.clear(); out.insert(in.begin(), in.end());
     return false;
 }
 
+bool
+Node::rdgobv(const BitVector &in, BitVector &out)
+{
+    Stats::count(STAT_VISIT_NODE);
+    Stats::count(STAT_SET_COPIES);
+    out = in;
+    return false;
+}
+
+void
+Node::rdsync(const DefTable &t)
+{
+    this->_entry = t.toMap(this->_bentry);
+    this->_exit = t.toMap(this->_bexit);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+const char *
+Expression::opstr(BinOp op)
+{
+    static const char *strs[] = {
+        "+", "-", "*", "/", "==", "<", "<=", ">", ">=", "||", "&&"
+    };
+    return strs[op];
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 void
-Identifier::buildAST(Painter *p, void *e, bool a) const
+Identifier::buildAST(Painter *p, PNode e, bool a) const
 {
-    string label = this->_id;
+    string label = *this->_name;
     if (a) label += " " + Base::int2string(this->label());
-    PNode n = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, n, "", 1);
+    PNode n = Painter::newNode(p, label);
+    Painter::newEdge(p, e, n);
     if (this->r) this->r->buildAST(p, n, a);
 }
 
+void
+Identifier::dflocals(DFLocals &f) const
+{
+    f.uses.push_back(this->_var);
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 void
-Int::buildAST(Painter *p, void *e, bool a) const
+Int::buildAST(Painter *p, PNode e, bool a) const
 {
     string label = Base::int2string(this->_value);
     if (a) label += " " + Base::int2string(this->label());
-    PNode n = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, n, "", 1);
+    PNode n = Painter::newNode(p, label);
+    Painter::newEdge(p, e, n);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 void
-Float::buildAST(Painter *p, void *e, bool a) const
+Float::buildAST(Painter *p, PNode e, bool a) const
 {
     string label = Base::float2string(this->_value);
     if (a) label += " " + Base::int2string(this->label());
-    PNode n = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, n, "", 1);
+    PNode n = Painter::newNode(p, label);
+    Painter::newEdge(p, e, n);
+}
+
+void
+Float::flatten(FlatAST &f) const
+{
+    uint32_t bits;
+    memcpy(&bits, &this->_value, sizeof(bits));
+    f.leaf(FLAT_FLOAT, bits);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 void
-Logical::buildAST(Painter *p, void *e, bool a) const
+Logical::buildAST(Painter *p, PNode e, bool a) const
 {
     string label = Base::bool2string(this->_value);
     if (a) label += " " + Base::int2string(this->label());
-    PNode n = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, n, "", 1);
+    PNode n = Painter::newNode(p, label);
+    Painter::newEdge(p, e, n);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -145,41 +193,39 @@ Logical::buildAST(Painter *p, void *e, bool a) const
 AssignmentExpression::AssignmentExpression(Identifier *id,
                                            Expression *expr)
 {
+    this->_var = id->var();
+    this->_gen = 0;
+    this->_kill = NULL;
     this->l = id;
     this->r = expr;
 }
 
-string
-AssignmentExpression::str(bool a) const
+void
+AssignmentExpression::print(Sink &out, bool a) const
 {
-    string out;
-    out = this->l->str(a);
-    out += " = ";
-    out += this->r->str(a);
-    return out;
+    this->l->print(out, a);
+    out << " = ";
+    this->r->print(out, a);
 }
 
 void
-AssignmentExpression::buildAST(Painter *p, void *e, bool a) const
+AssignmentExpression::buildAST(Painter *p, PNode e, bool a) const
 {
     string label  = "=";
     if (a) label += " " + Base::int2string(this->label());
-    PNode opNode = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, opNode, "", 1);
+    PNode opNode = Painter::newNode(p, label);
+    Painter::newEdge(p, e, opNode);
     this->l->buildAST(p, opNode, a);
     this->r->buildAST(p, opNode, a);
 }
 
-void
-AssignmentExpression::cfgPrep(Painter *p)
-{
-    this->_cfgnode = Painter::newNode(p, this->str(false), 1);
-}
-
 bool
 AssignmentExpression::rdgo(const vlabmap &in, vlabmap &out)
 {
-    string tvar = this->l->str(false);
+    Stats::count(STAT_VISIT_ASSIGN);
+    Stats::count(STAT_SET_COPIES, 4);
+    Stats::count(STAT_SET_COMPARES);
+    varid tvar = this->_var;
     auto b4 = this->_exit;
 
     out.clear();
@@ -195,93 +241,127 @@ AssignmentExpression::rdgo(const vlabmap &in, vlabmap &out)
     return b4 != this->_exit;
 }
 
+void
+AssignmentExpression::rdprep(DefTable &t)
+{
+    t.add(this->_var, this->_plabel, this);
+}
+
+bool
+AssignmentExpression::rdgobv(const BitVector &in, BitVector &out)
+{
+    Stats::count(STAT_VISIT_ASSIGN);
+    Stats::count(STAT_SET_COPIES);
+    out = in;
+    out.andNot(*this->_kill);
+    out.set(this->_gen);
+    /* the owning statement tracks changes */
+    return false;
+}
+
+void
+AssignmentExpression::dflocals(DFLocals &f) const
+{
+    /* the target is written, not read */
+    this->r->dflocals(f);
+    f.defines = true;
+    f.def = this->_var;
+}
+
+void
+AssignmentExpression::flatten(FlatAST &f) const
+{
+    unsigned i = f.open(FLAT_ASSIGN, 0, this->_var);
+    this->l->flatten(f);
+    this->r->flatten(f);
+    f.close(i);
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 ArithmeticExpression::ArithmeticExpression(Expression *l,
-                                           std::string *op,
+                                           BinOp op,
                                            Expression *r)
 {
     this->l = l;
-    this->_op = string(*op);
+    this->_op = op;
     this->r = r;
 }
 
-string
-ArithmeticExpression::str(bool a) const
+void
+ArithmeticExpression::print(Sink &out, bool a) const
 {
-    string out;
-    out = this->l->str(a);
-    out += " " + this->_op + " ";
-    out += this->r->str(a);
-    return out;
+    this->l->print(out, a);
+    out << ' ' << Expression::opstr(this->_op) << ' ';
+    this->r->print(out, a);
 }
 
 void
-ArithmeticExpression::buildAST(Painter *p, void *e, bool a) const
+ArithmeticExpression::buildAST(Painter *p, PNode e, bool a) const
 {
-    string label = this->_op;
+    string label = Expression::opstr(this->_op);
     if (a) label += " " + Base::int2string(this->label());
-    PNode opNode = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, opNode, "", 1);
+    PNode opNode = Painter::newNode(p, label);
+    Painter::newEdge(p, e, opNode);
     this->l->buildAST(p, opNode, a);
     this->r->buildAST(p, opNode, a);
 }
 
+void
+ArithmeticExpression::dflocals(DFLocals &f) const
+{
+    Node::dflocals(f);
+    f.exprs.push_back(this);
+}
+
+void
+ArithmeticExpression::flatten(FlatAST &f) const
+{
+    unsigned i = f.open(FLAT_ARITH, this->_op, 0, this->_not);
+    this->l->flatten(f);
+    this->r->flatten(f);
+    f.close(i);
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 LogicalExpression::LogicalExpression(Expression *l,
-                                     std::string *op,
+                                     BinOp op,
                                      Expression *r)
 {
     this->l = l;
-    this->_op = string(*op);
+    this->_op = op;
     this->r = r;
 }
 
-string
-LogicalExpression::str(bool a) const
+void
+LogicalExpression::print(Sink &out, bool a) const
 {
-    string out;
-    if (this->_not) out += "!(";
-    out += this->l->str(a);
-    out += " " + this->_op + " ";
-    out += this->r->str(a);
-    if (this->_not) out += ")";
-    return out;
+    if (this->_not) out << "!(";
+    this->l->print(out, a);
+    out << ' ' << Expression::opstr(this->_op) << ' ';
+    this->r->print(out, a);
+    if (this->_not) out << ')';
 }
 
 void
-LogicalExpression::buildAST(Painter *p, void *e, bool a) const
+LogicalExpression::buildAST(Painter *p, PNode e, bool a) const
 {
-    string label = this->_op;
+    string label = Expression::opstr(this->_op);
     if (a) label += " " + Base::int2string(this->label());
-    PNode opNode = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, opNode, "", 1);
+    PNode opNode = Painter::newNode(p, label);
+    Painter::newEdge(p, e, opNode);
     this->l->buildAST(p, opNode, a);
     this->r->buildAST(p, opNode, a);
 }
 
 void
-LogicalExpression::cfgPrep(Painter *p)
+LogicalExpression::flatten(FlatAST &f) const
 {
-    this->_cfgnode = Painter::newNode(p, this->str(false), 1);
-}
-
-bool
-LogicalExpression::rdgo(const vlabmap &in, vlabmap &out)
-{
-    vlabmap b4 = this->_entry, after;
-
-    set_union(this->_entry.begin(),
-              this->_entry.end(),
-              in.begin(),
-              in.end(),
-              inserter(after, after.end()));
-
-    out.clear(); out.insert(after.begin(), after.end());
-    this->_entry = this->_exit = after;
-
-    return b4 != after;
+    unsigned i = f.open(FLAT_LOGIC, this->_op, 0, this->_not);
+    this->l->flatten(f);
+    this->r->flatten(f);
+    f.close(i);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -292,41 +372,49 @@ Statement::Statement(Expression *expression)
     this->_expr = expression;
 }
 
-string
-Statement::str(bool a) const
+void
+Statement::print(Sink &out, bool a) const
 {
     unsigned realPadLen = this->_exprStatement ? 0 : this->depth();
-    string out = "";
     if (a) {
-        out += Base::pad(realPadLen) + "[";
+        out.pad(realPadLen) << '[';
     }
-    out += this->_expr->str(a);
+    this->_expr->print(out, a);
     if (a) {
-        out += "] -- " + Base::int2string(this->label());
+        out << "] -- " << this->label();
     }
     if (!this->_exprStatement) {
-        out += "\n";
+        out << '\n';
     }
-    return out;
 }
 
 void
-Statement::cfgStitch(Painter *p, void *in, void **out)
-{
-    Painter::newEdge(p, (PNode)in, (PNode)this->cfgnode(), "", 1);
-    *out = this->cfgnode();
-}
-
-vset
-Statement::getvs(void)
+Statement::flatten(FlatAST &f) const
 {
-    return this->_expr->getvs();
+    unsigned i = f.open(this->_exprStatement ? FLAT_TEST : FLAT_STMT);
+    this->_expr->flatten(f);
+    f.close(i);
 }
 
 bool
 Statement::rdgo(const vlabmap &in, vlabmap &out)
 {
-    this->_entry = in;
+    Stats::count(STAT_VISIT_STATEMENT);
+    Stats::count(STAT_SET_COPIES, 4);
+    Stats::count(STAT_SET_COMPARES);
+    if (this->_exprStatement) {
+        /* tests are join points: keep everything that has ever reached us */
+        vlabmap after;
+        set_union(this->_entry.begin(),
+                  this->_entry.end(),
+                  in.begin(),
+                  in.end(),
+                  inserter(after, after.end()));
+        this->_entry = after;
+    }
+    else {
+        this->_entry = in;
+    }
 
 #if 0
     Node::emitVLabSet(in);
@@ -348,6 +436,559 @@ Statement::rdgo(const vlabmap &in, vlabmap &out)
     return b4 != after;
 }
 
+bool
+Statement::rdgobv(const BitVector &in, BitVector &out)
+{
+    Stats::count(STAT_VISIT_STATEMENT);
+    Stats::count(STAT_SET_COPIES, 2);
+    Stats::count(STAT_SET_COMPARES);
+    /* tests are join points: keep everything that has ever reached us */
+    if (this->_exprStatement && this->_bentry.size()) {
+        this->_bentry |= in;
+    }
+    else {
+        this->_bentry = in;
+    }
+    this->_expr->rdgobv(this->_bentry, out);
+    bool update = out != this->_bexit;
+    this->_bexit = out;
+
+    return update;
+}
+
+void
+Statement::rdpropagate(const BitVector &in, BitVector &out)
+{
+    this->_expr->rdgobv(in, out);
+    this->rdbits(in, out);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+/* passes over blocks and statements. they keep their path in a heap-allocated
+ * stack instead of recursing, so a deeply nested program costs memory in
+ * proportion to its size but no call stack. blocks, ifs and whiles hand their
+ * own calls to these. */
+
+/* calls visit(n, i) before kid i of n, and once more with i == n->nkids()
+ * after the last one. visit returns false to skip kid i. */
+template <typename N, typename Visit>
+static void
+walk(N *root, Visit visit)
+{
+    struct Step {
+        N *n;
+        unsigned i, nkids;
+    };
+    vector<Step> path(1, Step{root, 0, root->nkids()});
+
+    while (!path.empty()) {
+        Step &s = path.back();
+        N *n = s.n;
+        unsigned i = s.i++;
+        bool in = visit(n, i);
+        if (i == s.nkids) {
+            path.pop_back();
+        }
+        else if (in) {
+            N *k = n->kid(i);
+            path.push_back(Step{k, 0, k->nkids()});
+        }
+    }
+}
+
+static void
+walkDepth(Node *root, unsigned depth)
+{
+    root->Node::depth(depth);
+    walk(root, [](Node *n, unsigned i) -> bool {
+        if (i == n->nkids()) return true;
+        /* tests sit at their statement's depth, everything else one deeper */
+        bool test = FLAT_BLOCK != n->kind() && 0 == i;
+        n->kid(i)->Node::depth(n->depth() + (test ? 0 : 1));
+        return true;
+    });
+}
+
+static void
+walkLabel(Node *root, int &label)
+{
+    /* first label of each open block */
+    vector<int> starts;
+
+    walk(root, [&](Node *n, unsigned i) -> bool {
+        if (FLAT_BLOCK == n->kind()) {
+            if (0 == i) starts.push_back(label);
+            if (n->nkids() == i) {
+                static_cast<Block *>(n)->span(starts.back(), label);
+                starts.pop_back();
+            }
+        }
+        /* ifs and whiles take theirs before their blocks' */
+        else if (0 == i) {
+            static_cast<Statement *>(n)->Statement::label(label);
+        }
+        return true;
+    });
+}
+
+static void
+walkPrint(const Node *root, Sink &out, bool a)
+{
+    walk(root, [&](const Node *n, unsigned i) -> bool {
+        switch (n->kind()) {
+        case FLAT_BLOCK:
+            break;
+        case FLAT_IF:
+            if (0 == i) out.pad(n->depth()) << "if ";
+            else if (1 == i) out << " then\n";
+            else if (2 == i) out.pad(n->depth()) << "else\n";
+            else out.pad(n->depth()) << "fi\n";
+            break;
+        case FLAT_WHILE:
+            if (0 == i) out.pad(n->depth()) << "while ";
+            else if (1 == i) out << " do\n";
+            else out.pad(n->depth()) << "od\n";
+            break;
+        default:
+            n->print(out, a);
+        }
+        return true;
+    });
+}
+
+static void
+walkAST(const Node *root, Painter *p, PNode e, bool a)
+{
+    static const char *ifs[] = {"[[TEST]]", "[[IF]]", "[[ELSE]]"};
+    static const char *whiles[] = {"[[TEST]]", "[[BODY]]"};
+    /* what the statements of the innermost open block hang from: e, or the
+     * section of an if or a while, which itself hangs from that node */
+    vector<PNode> at(1, e);
+
+    walk(root, [&](const Node *n, unsigned i) -> bool {
+        FlatKind k = n->kind();
+        if (FLAT_BLOCK == k) return true;
+        if (0 == n->nkids()) {
+            n->buildAST(p, at.back(), a);
+            return true;
+        }
+        if (0 == i) {
+            string label = FLAT_IF == k ? "if" : "while";
+            if (a) label += " " + Base::int2string(n->label());
+            PNode s = Painter::newNode(p, label);
+            Painter::newEdge(p, at.back(), s);
+            at.push_back(s);
+        }
+        /* done with the last section */
+        else at.pop_back();
+        if (i == n->nkids()) {
+            at.pop_back();
+            return true;
+        }
+        PNode s = Painter::newNode(p, FLAT_IF == k ? ifs[i] : whiles[i]);
+        Painter::newEdge(p, at.back(), s);
+        at.push_back(s);
+        return true;
+    });
+}
+
+static void
+walkFlatten(const Node *root, FlatAST &f)
+{
+    /* open blocks, ifs and whiles */
+    vector<unsigned> open;
+
+    walk(root, [&](const Node *n, unsigned i) -> bool {
+        if (0 == n->nkids()) {
+            n->flatten(f);
+        }
+        else if (0 == i) {
+            open.push_back(f.open(n->kind()));
+        }
+        else if (n->nkids() == i) {
+            f.close(open.back());
+            open.pop_back();
+        }
+        return true;
+    });
+}
+
+static void
+walkRDSync(Node *root, const DefTable &t)
+{
+    walk(root, [&](Node *n, unsigned i) -> bool {
+        if (0 == i && FLAT_BLOCK != n->kind()) n->Node::rdsync(t);
+        return true;
+    });
+}
+
+static void
+walkEmitRD(const Node *root, Sink &out, const SymbolTable &syms)
+{
+    walk(root, [&](const Node *n, unsigned i) -> bool {
+        if (0 == n->nkids()) {
+            n->emitrd(out, syms);
+        }
+        /* a loop's exit set follows its body */
+        else if (FLAT_WHILE == n->kind() && n->nkids() == i) {
+            Node::emitVLabSet(out, syms, n->rdexit());
+        }
+        return true;
+    });
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* the solver passes hand sets between calls, so they run on frames instead:
+ * one suspended call each, with its node, how far it got, its arguments and
+ * the locals it keeps while a kid runs. frames never move, so a kid writes
+ * straight into its parent's locals, and popped ones are kept for the next
+ * push, so their sets keep their storage. */
+template <typename Frame>
+class FrameStack {
+private:
+    std::vector<std::unique_ptr<Frame> > _frames;
+    size_t _size;
+
+public:
+    FrameStack(void) : _size(0) { ; }
+
+    bool empty(void) const { return 0 == this->_size; }
+
+    Frame &top(void) { return *this->_frames[this->_size - 1]; }
+
+    template <typename In, typename Out>
+    void push(Node *n, In in, Out out) {
+        if (this->_size == this->_frames.size()) {
+            this->_frames.push_back(std::unique_ptr<Frame>(new Frame()));
+        }
+        this->_frames[this->_size++]->reset(n, in, out);
+    }
+
+    void pop(void) { --this->_size; }
+};
+
+template <typename Set>
+struct RDFrame {
+    Node *n;
+    unsigned step;
+    const Set *in;
+    Set *out;
+    /* a block's ping-pong buffers, an if's branch results, a while's
+     * running set */
+    Set t, a, b;
+    const Set *ine;
+    Set *oute;
+    bool up, eup, bup, fup;
+    unsigned long iters;
+
+    /* t, a and b keep whatever the last call left: every step writes them
+     * before it reads them */
+    void reset(Node *node, const Set *i, Set *o) {
+        this->n = node;
+        this->step = 0;
+        this->in = i;
+        this->out = o;
+        this->ine = NULL;
+        this->oute = NULL;
+        this->up = this->eup = this->bup = this->fup = false;
+        this->iters = 0;
+    }
+};
+
+/* what the map and bit vector engines do differently */
+struct MapSets {
+    typedef vlabmap Set;
+
+    static bool go(Node *n, const Set &in, Set &out) {
+        return n->rdgo(in, out);
+    }
+
+    static void join(Set &out, const Set &b) {
+        Set u;
+        set_union(out.begin(), out.end(), b.begin(), b.end(),
+                  inserter(u, u.end()));
+        out.swap(u);
+    }
+
+    static void keep(Node *n, const Set &in, const Set &out) {
+        n->rdsets(in, out);
+    }
+
+    static size_t copies(size_t nstatements) { return nstatements + 1; }
+};
+
+struct BitSets {
+    typedef BitVector Set;
+
+    static bool go(Node *n, const Set &in, Set &out) {
+        return n->rdgobv(in, out);
+    }
+
+    static void join(Set &out, const Set &b) { out |= b; }
+
+    static void keep(Node *n, const Set &in, const Set &out) {
+        n->rdbits(in, out);
+    }
+
+    static size_t copies(size_t) { return 1; }
+};
+
+/* rdgo or rdgobv over the tree under root. returns whether any set moved. */
+template <typename S>
+static bool
+walkRD(Node *root, const typename S::Set &in, typename S::Set &out)
+{
+    typedef RDFrame<typename S::Set> Frame;
+    FrameStack<Frame> stack;
+    /* what the last call to finish returned */
+    bool ret = false;
+
+    stack.push(root, &in, &out);
+    while (!stack.empty()) {
+        Frame &f = stack.top();
+        Node *n = f.n;
+        switch (n->kind()) {
+        case FLAT_BLOCK:
+            if (0 == f.step) {
+                Stats::count(STAT_VISIT_BLOCK);
+                Stats::count(STAT_SET_COPIES, S::copies(n->nkids()));
+                f.ine = f.in;
+                f.oute = &f.a;
+            }
+            else {
+                /* ping-pong between two buffers. in may alias out. */
+                f.up = ret || f.up;
+                f.ine = f.oute;
+                f.oute = (f.oute == &f.a) ? &f.b : &f.a;
+            }
+            if (f.step < n->nkids()) {
+                stack.push(n->kid(f.step++), f.ine, f.oute);
+                continue;
+            }
+            *f.out = *f.ine;
+            ret = f.up;
+            break;
+        case FLAT_IF:
+            switch (f.step++) {
+            case 0:
+                Stats::count(STAT_VISIT_IF);
+                Stats::count(STAT_SET_COPIES, 2);
+                stack.push(n->kid(0), f.in, &f.t);
+                continue;
+            case 1:
+                f.eup = ret;
+                if (ForkJoin::tryInvoke(
+                        static_cast<IfStatement *>(n)->weight(),
+                        [&] { f.bup = walkRD<S>(n->kid(1), f.t, *f.out); },
+                        [&] { f.fup = walkRD<S>(n->kid(2), f.t, f.b); })) {
+                    break;
+                }
+                stack.push(n->kid(1), &f.t, f.out);
+                continue;
+            case 2:
+                f.bup = ret;
+                stack.push(n->kid(2), &f.t, &f.b);
+                continue;
+            default:
+                f.fup = ret;
+            }
+            S::join(*f.out, f.b);
+            S::keep(n, *f.in, *f.out);
+            ret = f.eup || f.bup || f.fup;
+            break;
+        case FLAT_WHILE:
+            switch (f.step++) {
+            case 0:
+                Stats::count(STAT_VISIT_WHILE);
+                Stats::count(STAT_SET_COPIES, 4);
+                f.t = *f.in;
+                stack.push(n->kid(0), &f.t, &f.t);
+                continue;
+            case 1:
+                f.eup = ret;
+                stack.push(n->kid(1), &f.t, &f.t);
+                continue;
+            case 2:
+                f.bup = ret;
+                stack.push(n->kid(0), &f.t, &f.t);
+                continue;
+            case 3:
+                f.fup = ret;
+                ++f.iters;
+                if (f.eup || f.bup || f.fup) {
+                    f.step = 1;
+                    stack.push(n->kid(0), &f.t, &f.t);
+                    continue;
+                }
+                Stats::loop(f.iters);
+                *f.out = f.t;
+                S::keep(n, *f.in, *f.out);
+                /* fixup entry expr */
+                stack.push(n->kid(0), f.out, &f.a);
+                continue;
+            }
+            ret = f.eup || f.bup || f.fup;
+            break;
+        default:
+            ret = S::go(n, *f.in, *f.out);
+        }
+        stack.pop();
+    }
+
+    return ret;
+}
+
+/* the region engine's top-down pass */
+static void
+walkRDPropagate(Node *root, const BitVector &in, BitVector &out)
+{
+    FrameStack<RDFrame<BitVector> > stack;
+
+    stack.push(root, &in, &out);
+    while (!stack.empty()) {
+        RDFrame<BitVector> &f = stack.top();
+        Node *n = f.n;
+        switch (n->kind()) {
+        case FLAT_BLOCK:
+            if (0 == f.step) {
+                f.ine = f.in;
+                f.oute = &f.a;
+            }
+            else {
+                f.ine = f.oute;
+                f.oute = (f.oute == &f.a) ? &f.b : &f.a;
+            }
+            if (f.step < n->nkids()) {
+                stack.push(n->kid(f.step++), f.ine, f.oute);
+                continue;
+            }
+            *f.out = *f.ine;
+            break;
+        case FLAT_IF:
+            switch (f.step++) {
+            case 0:
+                stack.push(n->kid(0), f.in, &f.t);
+                continue;
+            case 1:
+                if (ForkJoin::tryInvoke(
+                        static_cast<IfStatement *>(n)->weight(),
+                        [&] { walkRDPropagate(n->kid(1), f.t, *f.out); },
+                        [&] { walkRDPropagate(n->kid(2), f.t, f.b); })) {
+                    break;
+                }
+                stack.push(n->kid(1), &f.t, f.out);
+                continue;
+            case 2:
+                stack.push(n->kid(2), &f.t, &f.b);
+                continue;
+            }
+            *f.out |= f.b;
+            n->rdbits(*f.in, *f.out);
+            break;
+        case FLAT_WHILE:
+            switch (f.step++) {
+            case 0:
+                f.t = *f.in;
+                f.t |= static_cast<WhileStatement *>(n)->bodyGen();
+                stack.push(n->kid(0), &f.t, f.out);
+                continue;
+            case 1:
+                stack.push(n->kid(1), f.out, &f.a);
+                continue;
+            }
+            n->rdbits(*f.in, *f.out);
+            break;
+        default:
+            n->rdpropagate(*f.in, *f.out);
+        }
+        stack.pop();
+    }
+}
+
+/* the region engine's bottom-up pass. gen and kill come in cleared and
+ * sized. */
+static void
+walkRDSummary(Node *root, BitVector &gen, BitVector &kill)
+{
+    /* g and k summarize a block's current statement or an if's else branch;
+     * k collects a loop body's kills, which nothing needs */
+    struct Frame {
+        Node *n;
+        unsigned step;
+        BitVector *gen, *kill;
+        BitVector g, k;
+
+        void reset(Node *node, BitVector *gn, BitVector *kl) {
+            this->n = node;
+            this->step = 0;
+            this->gen = gn;
+            this->kill = kl;
+        }
+    };
+    FrameStack<Frame> stack;
+
+    stack.push(root, &gen, &kill);
+    while (!stack.empty()) {
+        Frame &f = stack.top();
+        Node *n = f.n;
+        switch (n->kind()) {
+        case FLAT_BLOCK:
+            if (0 == f.step) {
+                if (static_cast<Block *>(n)->rdsummaryFork(0, n->nkids(),
+                                                           *f.gen,
+                                                           *f.kill)) {
+                    break;
+                }
+            }
+            else {
+                /* later statements win */
+                f.gen->andNot(f.k);
+                *f.gen |= f.g;
+                *f.kill |= f.k;
+            }
+            if (f.step < n->nkids()) {
+                f.g.resize(f.gen->size());
+                f.k.resize(f.gen->size());
+                stack.push(n->kid(f.step++), &f.g, &f.k);
+                continue;
+            }
+            break;
+        case FLAT_IF:
+            if (0 == f.step++) {
+                f.g.resize(f.gen->size());
+                f.k.resize(f.gen->size());
+                if (!ForkJoin::tryInvoke(
+                        static_cast<IfStatement *>(n)->weight(),
+                        [&] { walkRDSummary(n->kid(1), *f.gen, *f.kill); },
+                        [&] { walkRDSummary(n->kid(2), f.g, f.k); })) {
+                    /* pushed in reverse, so the if branch runs first */
+                    stack.push(n->kid(2), &f.g, &f.k);
+                    stack.push(n->kid(1), f.gen, f.kill);
+                    continue;
+                }
+            }
+            /* either branch may generate, only both together kill */
+            *f.gen |= f.g;
+            *f.kill &= f.k;
+            break;
+        case FLAT_WHILE:
+            if (0 == f.step++) {
+                f.k.resize(f.gen->size());
+                stack.push(n->kid(1), f.gen, &f.k);
+                continue;
+            }
+            /* the loop head is in | gen no matter how many trips are taken,
+             * and nothing is killed on the path that skips the body */
+            static_cast<WhileStatement *>(n)->bodyGen() = *f.gen;
+            break;
+        default:
+            n->rdsummary(*f.gen, *f.kill);
+        }
+        stack.pop();
+    }
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 const int Block::ndias = 2;
@@ -356,185 +997,396 @@ const string Block::diaNames[Block::ndias] = {"ast", "dast"};
 void
 Block::label(int &label)
 {
-    this->_label = label;
-    for (Statement *s : this->_statements) {
-        s->label(label);
-    }
+    walkLabel(this, label);
 }
 
-string
-Block::str(bool a) const
+void
+Block::print(Sink &out, bool a) const
 {
-    string out = "";
-    for (Statement *s : this->_statements) {
-        out += s->str(a);
-    }
-    return out;
+    walkPrint(this, out, a);
 }
 
 void
-Block::buildAST(Painter *p, void *e, bool a) const
+Block::buildAST(Painter *p, PNode e, bool a) const
 {
-    for (Statement *s : this->_statements) {
-        s->buildAST(p, e, a);
-    }
+    walkAST(this, p, e, a);
 }
 
 void
 Block::depth(unsigned depth)
 {
-    this->_depth = depth;
-    for (Statement *s : this->_statements) {
-        s->depth(this->_depth + 1);
-    }
+    walkDepth(this, depth);
+}
+
+void
+Block::flatten(FlatAST &f) const
+{
+    walkFlatten(this, f);
 }
 
 void
-Block::drawASTs(std::string fprefix, std::string type)
+Block::drawASTs(std::string fprefix, std::string type, Paintings &out)
 {
     for (auto i = 0; i < Block::ndias; ++i) {
         string fname = fprefix + "-" + Block::diaNames[i];
         /* this is the top-level call, so construct the painter */
-        Painter *painter = new Painter(fname, type);
+        Painter *painter = Painter::create(fname, type);
+        out.push_back(painter);
         /* start the drawing process */
-        PNode n = Painter::newNode(painter, "[[PROGRAM]]", 1);
+        PNode n = Painter::newNode(painter, "[[PROGRAM]]");
         this->buildAST(painter, n, (Block::diaNames[i] == "dast"));
-        /* render the thing -- is that even the correct term? */
-        cout << "> -- writing " + fname + "." + type + " ... "; cout.flush();
-        painter->renderAST();
-        cout << "done" << endl;
-        delete painter;
     }
 }
 
 void
-Block::drawCFG(std::string fprefix, std::string type)
+Block::drawCFG(std::string fprefix, std::string type, Paintings &out)
 {
     string fname = fprefix + "-" + "cfg";
+    CFG g;
+    this->buildCFG(g);
     /* this is the top-level call, so construct the painter */
-    Painter *painter = new Painter(fname, type);
-    /* start the drawing process */
-    PNode n = Painter::newNode(painter, "[[PROGRAM]]", 1);
-    PNode e = Painter::newNode(painter, "[[PROGRAM END]]", 1);
-    PNode o = NULL;
-    this->cfgPrep(painter);
-    this->cfgStitch(painter, n, (void **)&o);
-    Painter::newEdge(painter, o, e, "", 1);
-    /* render the thing -- is that even the correct term? */
-    cout << "> -- writing " + fname + "." + type + " ... "; cout.flush();
-    painter->renderAST();
-    cout << "done" << endl;
-    delete painter;
+    Painter *painter = Painter::create(fname, type);
+    out.push_back(painter);
+    /* the graph is already built, so just copy it over */
+    vector<PNode> pnodes(g.size());
+    for (unsigned n = 0; n < g.size(); ++n) {
+        pnodes[n] = Painter::newNode(painter, g.text(n));
+    }
+    for (unsigned e = 0; e < g.nedges(); ++e) {
+        Painter::newEdge(painter, pnodes[g.edge(e).first],
+                         pnodes[g.edge(e).second]);
+    }
 }
 
 void
-Block::cfgPrep(Painter *p)
+Block::buildCFG(CFG &g)
 {
-    for (Statement *s : this->_statements) {
-        s->cfgPrep(p);
-    }
+    unsigned entry = g.newNode(CFG_ENTRY);
+    unsigned exit = g.newNode(CFG_EXIT);
+    Node *root = this;
+    /* statement and test nodes first, in preorder. a test belongs to its if
+     * or while, so test blocks are skipped. */
+    walk(root, [&](Node *n, unsigned i) -> bool {
+        if (0 == i) n->cfgPrep(g);
+        return 0 != i || FLAT_BLOCK == n->kind();
+    });
+    /* then the edges, following the node control is in. merges are made on
+     * the way back up. */
+    unsigned at = entry;
+    /* if branches waiting for their merge */
+    vector<unsigned> ifOuts;
+    walk(root, [&](Node *n, unsigned i) -> bool {
+        FlatKind k = n->kind();
+        if (FLAT_BLOCK == k) return true;
+        if (0 == n->nkids()) {
+            g.newEdge(at, n->cfgnode());
+            at = n->cfgnode();
+            return true;
+        }
+        unsigned test = n->cfgnode();
+        if (0 == i) {
+            g.newEdge(at, test);
+            return false;
+        }
+        if (FLAT_IF == k && 2 == i) ifOuts.push_back(at);
+        if (i < n->nkids()) {
+            at = test;
+            return true;
+        }
+        Statement *s = static_cast<Statement *>(n);
+        unsigned merge = g.newNode(CFG_MERGE, s, s);
+        if (FLAT_IF == k) {
+            g.newEdge(ifOuts.back(), merge);
+            g.newEdge(at, merge);
+            ifOuts.pop_back();
+        }
+        else {
+            g.newEdge(at, test);
+            g.newEdge(test, merge);
+        }
+        at = merge;
+        return true;
+    });
+    g.newEdge(at, exit);
+    g.finalize();
 }
 
-vset
-Block::getvs(void)
+vlabmap
+Block::genStartSet(void) const
 {
-    vset n;
-
-    for (Statement *s : this->_statements) {
-        vset t = s->getvs();
-        n.insert(t.begin(), t.end());
+    vlabmap ret;
+    for (varid v = 0; v < this->_nvars; ++v) {
+        ret.insert(ret.end(), make_pair(v, -1));
     }
+    return ret;
+}
 
-    return n;
+/* runs root under a scheduler with nthreads workers. with one thread, or a
+ * program lighter than a single fork, no fork could happen, so root runs
+ * right here without starting any. the scheduler's counts only go to
+ * --stats, so the report reads the same however many threads ran. */
+static void
+forkRun(ostream &os,
+        unsigned nthreads,
+        size_t forkmin,
+        size_t weight,
+        const function<void(void)> &root)
+{
+    if (nthreads < 2 || weight < forkmin) {
+        root();
+    }
+    else {
+        ForkJoin fj(nthreads, forkmin);
+        fj.run(root);
+        Stats::count(STAT_FORKS_SPAWNED, fj.spawned());
+        Stats::count(STAT_FORKS_INLINED, fj.inlined());
+    }
+    os << "> -- done ..." << endl;
 }
 
 void
-Block::cfgStitch(Painter *p, void *in, void **out)
+Block::rdcalc(ostream &os,
+              const SymbolTable &syms,
+              RDEngine engine,
+              unsigned nthreads,
+              size_t forkmin)
 {
-    PNode ine = NULL, oute = NULL;
-    bool first = true;
-    for (Statement *s : this->_statements) {
-        if (first) {
-            s->cfgStitch(p, in, (void **)&oute);
-            first = false;
-            ine = oute;
+    os << "> -- starting fixed point iteration ..." << endl;
+    if (RD_ENGINE_FLAT == engine) {
+        FlatAST f;
+        this->flatten(f);
+        f.label();
+        f.rdcalc(os, syms, this->_nvars);
+        return;
+    }
+    if (RD_ENGINE_MAP == engine) {
+        auto sset = this->genStartSet();
+        forkRun(os, nthreads, forkmin, this->weight(),
+                [&] { this->rdgo(sset, sset); });
+    }
+    else {
+        DefTable defs(this->_nvars);
+        for (AssignmentExpression *a : this->_defsites) a->rdprep(defs);
+        defs.seal();
+        BitVector sset = defs.startSet();
+        if (RD_ENGINE_WORKLIST == engine) {
+            CFG g;
+            this->buildCFG(g);
+            RDWorklist wl(g, defs);
+            wl.solve(sset);
+            wl.publish();
+            os << "> -- done after " << wl.visits() << " node visits ..."
+               << endl;
+        }
+        else if (RD_ENGINE_PARALLEL == engine) {
+            CFG g;
+            this->buildCFG(g);
+            RDWorklist wl(g, defs);
+            wl.solve(sset, nthreads);
+            wl.publish();
+            os << "> -- done after " << wl.visits() << " node visits in "
+               << wl.nslices() << " slices ..." << endl;
+        }
+        else if (RD_ENGINE_DATAFLOW == engine) {
+            CFG g;
+            this->buildCFG(g);
+            RDAnalysis rd(g, defs);
+            DFSolver<RDAnalysis> s(g, rd);
+            s.solve();
+            RDAnalysis::publish(g, s);
+            os << "> -- done after " << s.visits() << " node visits ..."
+               << endl;
+        }
+        else if (RD_ENGINE_REGION == engine) {
+            BitVector gen(defs.size()), kill(defs.size());
+            forkRun(os, nthreads, forkmin, this->weight(), [&] {
+                this->rdsummary(gen, kill);
+                this->rdpropagate(sset, sset);
+            });
+        }
+        else if (RD_ENGINE_SSA == engine) {
+            CFG g;
+            this->buildCFG(g);
+            SSAForm ssa(g, defs);
+            ssa.solve();
+            ssa.publish();
+            os << "> -- done after " << ssa.visits() << " phi visits over "
+               << ssa.nvalues() << " ssa values (" << ssa.nphis()
+               << " phis, " << ssa.nuses() << " uses) ..." << endl;
+        }
+        else if (RD_ENGINE_BBLOCK == engine) {
+            CFG g;
+            this->buildCFG(g);
+            BasicBlocks bbs(g);
+            RDBlocks rb(bbs, defs);
+            rb.solve(sset);
+            rb.publish();
+            os << "> -- done after " << rb.visits() << " visits to "
+               << bbs.size() << " basic blocks ..." << endl;
         }
         else {
-            s->cfgStitch(p, ine, (void **)&oute);
-            ine = oute;
+            forkRun(os, nthreads, forkmin, this->weight(),
+                    [&] { this->rdgobv(sset, sset); });
         }
+        this->rdsync(defs);
     }
-    *out = oute;
+    os << "> -- here are the rd sets ..." << endl;
+    Sink out(os);
+    this->emitrd(out, syms);
 }
 
 void
-Block::rdcalc(void)
+Block::dfcalc(ostream &os, const SymbolTable &syms, DFAnalysis a)
 {
-    auto sset = this->genStartSet();
-
-    cout << "> -- starting fixed point iteration ..." << endl;
-    this->rdgo(sset, sset);
-    cout << "> -- done ..." << endl;
-    cout << "> -- here are the rd sets ..." << endl;
-    this->emitrd();
+    CFG g;
+    this->buildCFG(g);
+    if (DF_DEF_USE == a) {
+        os << "> -- def-use chains ..." << endl;
+        DefTable defs(this->_nvars);
+        for (AssignmentExpression *d : this->_defsites) d->rdprep(defs);
+        defs.seal();
+        SSAForm ssa(g, defs);
+        ssa.solve();
+        Sink out(os);
+        ssaemit(out, syms, g, defs, ssa);
+        return;
+    }
+    DFUniverse u(g);
+
+    if (DF_LIVE == a) {
+        os << "> -- live variables ..." << endl;
+        LiveVariables lv(u);
+        DFSolver<LiveVariables> s(g, lv);
+        s.solve();
+        dfemit(os, syms, u, s, true);
+    }
+    else if (DF_AVAILABLE == a) {
+        os << "> -- available expressions ..." << endl;
+        AvailableExpressions ae(u);
+        DFSolver<AvailableExpressions> s(g, ae);
+        s.solve();
+        dfemit(os, syms, u, s, false);
+    }
+    else {
+        os << "> -- very busy expressions ..." << endl;
+        VeryBusyExpressions vb(u);
+        DFSolver<VeryBusyExpressions> s(g, vb);
+        s.solve();
+        dfemit(os, syms, u, s, false);
+    }
 }
 
 bool
 Block::rdgo(const vlabmap &in, vlabmap &out)
 {
-    vlabmap ine, oute;
-    bool first = true, update = false;
+    return walkRD<MapSets>(this, in, out);
+}
 
-    for (Statement *s : this->_statements) {
-        if (first) {
-            update = s->rdgo(in, oute) || update;
-            first = false;
-            ine = oute;
-        }
-        else {
-            update = s->rdgo(ine, oute) || update;
-            ine = oute;
-        }
+bool
+Block::rdgobv(const BitVector &in, BitVector &out)
+{
+    return walkRD<BitSets>(this, in, out);
+}
+
+void
+Block::rdsync(const DefTable &t)
+{
+    walkRDSync(this, t);
+}
+
+void
+Block::rdsummary(BitVector &gen, BitVector &kill)
+{
+    walkRDSummary(this, gen, kill);
+}
+
+/* summaries compose associatively, so the two halves are summarized
+ * independently and then joined */
+bool
+Block::rdsummaryFork(size_t b, size_t e, BitVector &gen, BitVector &kill)
+{
+    const Statementps &ss = this->_statements;
+    size_t weight = (e < ss.size() ? ss[e]->label() - 1 : this->_end) -
+                    (b < e ? ss[b]->label() - 1 : this->_end);
+    size_t m = b + (e - b) / 2;
+    BitVector lgen, lkill;
+
+    if (e - b < 2) return false;
+    if (!ForkJoin::tryInvoke(weight / 2,
+                             [&] {
+                                 lgen.resize(gen.size());
+                                 lkill.resize(gen.size());
+                                 this->rdsummary(b, m, lgen, lkill);
+                             },
+                             [&] { this->rdsummary(m, e, gen, kill); })) {
+        return false;
     }
-    out.clear(); out.insert(oute.begin(), oute.end());
+    /* later statements win */
+    lgen.andNot(kill);
+    gen |= lgen;
+    kill |= lkill;
 
-    return update;
+    return true;
+}
+
+/* summarizes statements [b, e) for rdsummaryFork: its halves again if they
+ * are heavy enough, in order otherwise */
+void
+Block::rdsummary(size_t b, size_t e, BitVector &gen, BitVector &kill)
+{
+    if (this->rdsummaryFork(b, e, gen, kill)) return;
+
+    BitVector sgen(gen.size()), skill(gen.size());
+    for (size_t i = b; i < e; ++i) {
+        sgen.clear();
+        skill.clear();
+        walkRDSummary(this->_statements[i], sgen, skill);
+        gen.andNot(skill);
+        gen |= sgen;
+        kill |= skill;
+    }
+}
+
+void
+Block::rdpropagate(const BitVector &in, BitVector &out)
+{
+    walkRDPropagate(this, in, out);
+}
+
+void
+Block::emitrd(Sink &out, const SymbolTable &syms) const
+{
+    walkEmitRD(this, out, syms);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 void
-Skip::buildAST(Painter *p, void *e, bool a) const
+Skip::buildAST(Painter *p, PNode e, bool a) const
 {
     string label = "skip";
     if (a) label += " " + Base::int2string(this->label());
-    PNode n = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, n, "", 1);
+    PNode n = Painter::newNode(p, label);
+    Painter::newEdge(p, e, n);
 }
 
-string
-Skip::str(bool a) const
+void
+Skip::print(Sink &out, bool a) const
 {
-    std::string out = "";
     if (a) {
-        out += Base::pad(this->depth()) + "[";
+        out.pad(this->depth()) << '[';
     }
-    out += "skip";
+    out << "skip";
     if (a) {
-        out += "] -- " + Base::int2string(this->label()) + "\n";
+        out << "] -- " << this->label() << '\n';
     }
-    return out;
-}
-
-void
-Skip::cfgPrep(Painter *p)
-{
-    this->_cfgnode = Painter::newNode(p, this->str(false), 1);
 }
 
 bool
 Skip::rdgo(const vlabmap &in, vlabmap &out)
 {
+    Stats::count(STAT_VISIT_SKIP);
+    Stats::count(STAT_SET_COPIES, 3);
     //Node::emitVLabSet(in);
     //cout << this->str(false) << endl;
     this->_entry = in;
@@ -544,13 +1396,23 @@ Skip::rdgo(const vlabmap &in, vlabmap &out)
     return false;
 }
 
+bool
+Skip::rdgobv(const BitVector &in, BitVector &out)
+{
+    Stats::count(STAT_VISIT_SKIP);
+    Stats::count(STAT_SET_COPIES, 3);
+    this->_bentry = in;
+    out = in;
+    this->_bexit = out;
+    return false;
+}
+
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 IfStatement::IfStatement(Block *expr,
                          Block *ifBlock,
                          Block *elseBlock)
 {
-    this->_meta = "if";
     this->_exprBlock = expr;
     this->_ifBlock = ifBlock;
     this->_elseBlock = elseBlock;
@@ -559,217 +1421,151 @@ IfStatement::IfStatement(Block *expr,
 void
 IfStatement::depth(unsigned depth)
 {
-    this->_depth = depth;
-    this->_exprBlock->depth(depth);
-    this->_ifBlock->depth(depth + 1);
-    this->_elseBlock->depth(depth + 1);
+    walkDepth(this, depth);
 }
 
 void
 IfStatement::label(int &label)
 {
-    this->_label = ++label;
-    this->_exprBlock->label(label);
-    this->_ifBlock->label(label);
-    this->_elseBlock->label(label);
+    walkLabel(this, label);
 }
 
 void
-IfStatement::buildAST(Painter *p, void *e, bool a) const
+IfStatement::buildAST(Painter *p, PNode e, bool a) const
 {
-    string label = "if";
-    if (a) label += " " + Base::int2string(this->label());
-    PNode ifNode = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, ifNode, "", 1);
-    PNode ifTest = Painter::newNode(p, "[[TEST]]", 1);
-    Painter::newEdge(p, ifNode, ifTest, "", 1);
-    this->_exprBlock->buildAST(p, ifTest, a);
-    PNode ifBody = Painter::newNode(p, "[[IF]]", 1);
-    Painter::newEdge(p, ifNode, ifBody, "", 1);
-    this->_ifBlock->buildAST(p, ifBody, a);
-    PNode elseBody = Painter::newNode(p, "[[ELSE]]", 1);
-    Painter::newEdge(p, ifNode, elseBody, "", 1);
-    this->_elseBlock->buildAST(p, elseBody, a);
+    walkAST(this, p, e, a);
 }
 
-string
-IfStatement::str(bool a) const
+void
+IfStatement::print(Sink &out, bool a) const
 {
-    string out = Base::pad(this->depth()) + "if ";
-    out += this->_exprBlock->str(a) + " then\n";
-    out += this->_ifBlock->str(a);
-    out += Base::pad(this->depth()) + "else\n";
-    out += this->_elseBlock->str(a);
-    out += Base::pad(this->depth()) + "fi\n";
-    return out;
+    walkPrint(this, out, a);
 }
 
 void
-IfStatement::cfgPrep(Painter *p)
+IfStatement::cfgPrep(CFG &g)
 {
-    this->_cfgnode = Painter::newNode(p, "if " +
-                     this->_exprBlock->str(false), 1);
-    this->_ifBlock->cfgPrep(p);
-    this->_elseBlock->cfgPrep(p);
+    this->_cfgnode = g.newNode(CFG_TEST, this->_exprBlock->statement(0), this);
 }
 
 void
-IfStatement::cfgStitch(Painter *p, void *in, void **out)
+IfStatement::flatten(FlatAST &f) const
 {
-    Painter::newEdge(p, (PNode)in, (PNode)this->cfgnode(), "", 1);
-    PNode ifOut = NULL, elseOut = NULL;
-    this->_ifBlock->cfgStitch(p, (PNode)this->cfgnode(), (void **)&ifOut);
-    this->_elseBlock->cfgStitch(p, (PNode)this->cfgnode(), (void **)&elseOut);
-    PNode merge = Painter::newNode(p, " ", 1);
-    Painter::newEdge(p, ifOut, merge, "", 1);
-    Painter::newEdge(p, elseOut, merge, "", 1);
-    *out = merge;
+    walkFlatten(this, f);
 }
 
-vset
-IfStatement::getvs(void)
+bool
+IfStatement::rdgo(const vlabmap &in, vlabmap &out)
 {
-    vset n, t;
-    t = this->_exprBlock->getvs();
-    n.insert(t.begin(), t.end());
-    t = this->_ifBlock->getvs();
-    n.insert(t.begin(), t.end());
-    t = this->_elseBlock->getvs();
-    n.insert(t.begin(), t.end());
-    return n;
+    return walkRD<MapSets>(this, in, out);
 }
 
 bool
-IfStatement::rdgo(const vlabmap &in, vlabmap &out)
+IfStatement::rdgobv(const BitVector &in, BitVector &out)
 {
-    vlabmap tout, ifout, elseout, tmp;
-
-    bool eup = this->_exprBlock->rdgo(in, tout);
-    bool bup = this->_ifBlock->rdgo(tout, ifout);
-    bool fup = this->_elseBlock->rdgo(tout, elseout);
-
-    out.clear();
-    set_union(ifout.begin(),
-              ifout.end(),
-              elseout.begin(),
-              elseout.end(),
-              inserter(out, out.end()));
+    return walkRD<BitSets>(this, in, out);
+}
 
-    set_union(tout.begin(),
-              tout.end(),
-              out.begin(),
-              out.end(),
-              inserter(tmp, tmp.end()));
+void
+IfStatement::rdsync(const DefTable &t)
+{
+    walkRDSync(this, t);
+}
 
-    out.clear(); out.insert(tmp.begin(), tmp.end());
+void
+IfStatement::rdsummary(BitVector &gen, BitVector &kill)
+{
+    walkRDSummary(this, gen, kill);
+}
 
-    this->_entry = in;
-    this->_exit = out;
+void
+IfStatement::rdpropagate(const BitVector &in, BitVector &out)
+{
+    walkRDPropagate(this, in, out);
+}
 
-    return eup || bup || fup;
+void
+IfStatement::emitrd(Sink &out, const SymbolTable &syms) const
+{
+    walkEmitRD(this, out, syms);
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
 WhileStatement::WhileStatement(Block *expr, Block *bodyBlock)
 {
-    this->_meta = "while";
     this->_exprBlock = expr;
     this->_bodyBlock = bodyBlock;
 }
 
-string
-WhileStatement::str(bool a) const
+void
+WhileStatement::print(Sink &out, bool a) const
 {
-    string out = Base::pad(this->depth()) + "while ";
-    out += this->_exprBlock->str(a) + " do\n";
-    out += this->_bodyBlock->str(a);
-    out += Base::pad(this->depth()) + "od\n";
-    return out;
+    walkPrint(this, out, a);
 }
 
 void
 WhileStatement::depth(unsigned depth)
 {
-    this->_depth = depth;
-    this->_exprBlock->depth(depth);
-    this->_bodyBlock->depth(depth + 1);
+    walkDepth(this, depth);
 }
 
 void
 WhileStatement::label(int &label)
 {
-    this->_label = ++label;
-    this->_exprBlock->label(label);
-    this->_bodyBlock->label(label);
+    walkLabel(this, label);
 }
 
 void
-WhileStatement::buildAST(Painter *p, void *e, bool a) const
+WhileStatement::buildAST(Painter *p, PNode e, bool a) const
 {
-    string label = "while";
-    if (a) label += " " + Base::int2string(this->label());
-    PNode whileNode = Painter::newNode(p, label, 1);
-    Painter::newEdge(p, (PNode)e, whileNode, "", 1);
-    PNode test = Painter::newNode(p, "[[TEST]]", 1);
-    Painter::newEdge(p, whileNode, test, "", 1);
-    this->_exprBlock->buildAST(p, test, a);
-    PNode body = Painter::newNode(p, "[[BODY]]", 1);
-    Painter::newEdge(p, whileNode, body, "", 1);
-    this->_bodyBlock->buildAST(p, body, a);
+    walkAST(this, p, e, a);
 }
 
 void
-WhileStatement::cfgPrep(Painter *p)
+WhileStatement::cfgPrep(CFG &g)
 {
-    string label = "if " + this->_exprBlock->str(false);
-    this->_cfgnode = Painter::newNode(p, label, 1); 
-    this->_bodyBlock->cfgPrep(p);
+    this->_cfgnode = g.newNode(CFG_TEST, this->_exprBlock->statement(0), this);
 }
 
 void
-WhileStatement::cfgStitch(Painter *p, void *in, void **out)
+WhileStatement::flatten(FlatAST &f) const
 {
-    Painter::newEdge(p, (PNode)in, (PNode)this->cfgnode(), "", 1);
-    PNode wOut;
-    this->_bodyBlock->cfgStitch(p, (PNode)this->cfgnode(), (void **)&wOut);
-    Painter::newEdge(p, wOut, (PNode)this->cfgnode(), "", 1);
-    PNode merge = Painter::newNode(p, " ", 1);
-    Painter::newEdge(p, (PNode)this->cfgnode(), merge, "", 1);
-    *out = merge;
+    walkFlatten(this, f);
 }
 
-vset
-WhileStatement::getvs(void)
+bool
+WhileStatement::rdgo(const vlabmap &in, vlabmap &out)
 {
-    vset n, t;
-
-    t = this->_exprBlock->getvs();
-    n.insert(t.begin(), t.end());
-    t = this->_bodyBlock->getvs();
-    n.insert(t.begin(), t.end());
-
-    return n;
+    return walkRD<MapSets>(this, in, out);
 }
 
 bool
-WhileStatement::rdgo(const vlabmap &in, vlabmap &out)
+WhileStatement::rdgobv(const BitVector &in, BitVector &out)
 {
-    bool eup = false, bup = false, fup = false;
+    return walkRD<BitSets>(this, in, out);
+}
 
-    vlabmap tout = in, esav, osav;
-    do {
-        eup = this->_exprBlock->rdgo(tout, tout);
-        bup = this->_bodyBlock->rdgo(tout, tout);
-        fup = this->_exprBlock->rdgo(tout, tout);
-    } while (eup || bup || fup);
+void
+WhileStatement::rdsync(const DefTable &t)
+{
+    walkRDSync(this, t);
+}
 
-    out.clear(); out.insert(tout.begin(), tout.end());
+void
+WhileStatement::rdsummary(BitVector &gen, BitVector &kill)
+{
+    walkRDSummary(this, gen, kill);
+}
 
-    this->_entry = in;
-    this->_exit = out;
-    /* fixup entry expr */
-    this->_exprBlock->rdgo(out, esav);
+void
+WhileStatement::rdpropagate(const BitVector &in, BitVector &out)
+{
+    walkRDPropagate(this, in, out);
+}
 
-    return eup || bup || fup;
+void
+WhileStatement::emitrd(Sink &out, const SymbolTable &syms) const
+{
+    walkEmitRD(this, out, syms);
 }
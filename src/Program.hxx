@@ -23,19 +23,78 @@
 #endif
 
 #include "Base.hxx"
+#include "BitVector.hxx"
+#include "CFG.hxx"
+#include "FlatAST.hxx"
+#include "Painter.hxx"
+#include "Sink.hxx"
+#include "SymbolTable.hxx"
 
 #include <string>
 #include <vector>
-#include <set>
 #include <utility>
 #include <map>
+#include <algorithm>
 
-class Painter;
+class DefTable;
+struct DFLocals;
 
-/* variable set */
-typedef std::set<std::string> vset;
 /* variable, label multimap */
-typedef std::multimap<std::string, int> vlabmap;
+typedef std::multimap<varid, int> vlabmap;
+/* diagrams waiting to be rendered */
+typedef std::vector<Painter *> Paintings;
+
+/* reaching definitions solvers */
+enum RDEngine {
+    /* syntax-directed, over vlabmaps */
+    RD_ENGINE_MAP = 0,
+    /* syntax-directed, over dense definition bit vectors */
+    RD_ENGINE_BITVEC,
+    /* worklist over the control flow graph */
+    RD_ENGINE_WORKLIST,
+    /* worklist over basic blocks */
+    RD_ENGINE_BBLOCK,
+    /* bottom-up region summaries, then one top-down pass */
+    RD_ENGINE_REGION,
+    /* worklist over the control flow graph, variables split across threads */
+    RD_ENGINE_PARALLEL,
+    /* the generic dataflow framework over the control flow graph */
+    RD_ENGINE_DATAFLOW,
+    /* worklist over a control flow graph built from a FlatAST */
+    RD_ENGINE_FLAT,
+    /* ssa form over the control flow graph, solved over phis only */
+    RD_ENGINE_SSA
+};
+
+/* analyses on the generic dataflow framework besides reaching definitions */
+enum DFAnalysis {
+    /* backward, may: variables read before they are written again */
+    DF_LIVE = 0,
+    /* forward, must: expressions computed on every path and still valid */
+    DF_AVAILABLE,
+    /* backward, must: expressions computed on every path before their
+     * operands change */
+    DF_VERY_BUSY,
+    /* not a dataflow problem: ssa def-use chains. the definitions reaching
+     * each read, and the reads of each definition. */
+    DF_DEF_USE
+};
+
+/* binary operators */
+enum BinOp {
+    OP_ADD = 0,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_EQ,
+    OP_LT,
+    OP_LTE,
+    OP_GT,
+    OP_GTE,
+    OP_OR,
+    OP_AND,
+    OP_NOPS
+};
 
 /* ////////////////////////////////////////////////////////////////////////// */
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -51,22 +110,22 @@ protected:
     /* right child pointer */
     Node *r;
     /* graph node for control flow graph */
-    void *_cfgnode;
-    /* set of variables */
-    vset _vars;
+    unsigned _cfgnode;
     /* entry point */
     vlabmap _entry;
     /* exit point */
     vlabmap _exit;
+    /* entry point (bit vector engine) */
+    BitVector _bentry;
+    /* exit point (bit vector engine) */
+    BitVector _bexit;
     /* not */
     bool _not;
 
 public:
-    static const std::string BOGUS_VAR;
-
     Node(void) { this->l = NULL;
                  this->r = NULL;
-                 this->_cfgnode = NULL;
+                 this->_cfgnode = CFG::NONE;
                  this->_not = false;
                  this->_depth = 0;
                  this->_plabel = 0;
@@ -81,33 +140,61 @@ public:
     virtual int label(void) const { return this->_label; }
 
     virtual void label(int &label) { this->_label = ++label; }
+    /* what this node flattens to */
+    virtual FlatKind kind(void) const = 0;
+    /* kids of the iterative passes: a block's statements, or the blocks of
+     * an if or a while. expressions have none; the grammar keeps them a few
+     * levels deep, so their own passes still recurse. */
+    virtual unsigned nkids(void) const { return 0; }
+
+    virtual Node *kid(unsigned i) const { return NULL; }
+    /* bool a = annotated. goes through print. */
+    virtual std::string str(bool a) const;
+    /* writes str(a) to out */
+    virtual void print(Sink &out, bool a) const = 0;
     /* bool a = annotated */
-    virtual std::string str(bool a) const = 0;
-    /* bool a = annotated */
-    virtual void buildAST(Painter *p, void *e, bool a) const = 0;
+    virtual void buildAST(Painter *p, PNode e, bool a) const = 0;
     /* prep for cfg creation */
-    virtual void cfgPrep(Painter *p) { this->cfgPrep(p); }
-
-    virtual void *cfgnode(void) { return this->_cfgnode; }
-
-    virtual void cfgStitch(Painter *p, void *in, void **out) {
-        this->cfgStitch(p, in, out);
-    }
-    virtual vset getvs(void);
-
-    unsigned nvars(void) const { return this->_vars.size(); }
-
-    virtual void varclean(void);
+    virtual void cfgPrep(CFG &g) { ; }
 
-    virtual void emitVars(void) const;
+    virtual unsigned cfgnode(void) const { return this->_cfgnode; }
 
-    vlabmap genStartSet(void) const;
-
-    static void emitVLabSet(const vlabmap &s);
+    static void emitVLabSet(Sink &out,
+                            const SymbolTable &syms,
+                            const vlabmap &s);
+    /* variables [0, nvars) in name order */
+    static void emitVars(std::ostream &os,
+                         const SymbolTable &syms,
+                         varid nvars);
 
     virtual bool rdgo(const vlabmap &in, vlabmap &out);
 
-    virtual void emitrd(void) const = 0;
+    virtual bool rdgobv(const BitVector &in, BitVector &out);
+    /* set bit vector results computed elsewhere */
+    void rdbits(const BitVector &entry, const BitVector &exit) {
+        this->_bentry = entry;
+        this->_bexit = exit;
+    }
+    /* set map results computed elsewhere */
+    void rdsets(const vlabmap &entry, const vlabmap &exit) {
+        this->_entry = entry;
+        this->_exit = exit;
+    }
+
+    const vlabmap &rdexit(void) const { return this->_exit; }
+    /* convert bit vector results into entry and exit sets */
+    virtual void rdsync(const DefTable &t);
+    /* summarize this node as out = gen | (in & ~kill). gen and kill come in
+     * cleared and sized. */
+    virtual void rdsummary(BitVector &gen, BitVector &kill) { ; }
+    /* set entry and exit sets from in using summaries */
+    virtual void rdpropagate(const BitVector &in, BitVector &out) { out = in; }
+    /* add what this node reads and writes to f */
+    virtual void dflocals(DFLocals &f) const;
+    /* append this subtree to f in preorder */
+    virtual void flatten(FlatAST &f) const = 0;
+
+    virtual void emitrd(Sink &out, const SymbolTable &syms) const = 0;
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -118,40 +205,47 @@ public:
 
     virtual ~Expression(void) { ; }
 
-    virtual std::string str(bool a) const = 0;
-
-    virtual void buildAST(Painter *p, void *e, bool a) const = 0;
+    virtual void buildAST(Painter *p, PNode e, bool a) const = 0;
 
     void notit(void) { this->_not = !this->_not; }
 
-    virtual void emitrd(void) const = 0;
+    static const char *opstr(BinOp op);
+
+    virtual void emitrd(Sink &out, const SymbolTable &syms) const {
+        this->print(out, false);
+    }
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
 class Identifier : public Expression {
 private:
-    std::string _id;
+    varid _var;
+    /* interned name, owned by the symbol table */
+    const std::string *_name;
 
 public:
-    Identifier(void) : Expression() { ; }
+    Identifier(void) : Expression(), _var(0), _name(NULL) { ; }
 
     ~Identifier(void) { ; }
 
-    Identifier(std::string id) : Expression(), _id(id) { ; }
+    Identifier(varid var, const std::string *name) :
+        Expression(), _var(var), _name(name) { ; }
+
+    varid var(void) const { return this->_var; }
+
+    virtual FlatKind kind(void) const { return FLAT_IDENT; }
 
-    std::string str(bool a) const {
-        std::string out;
-        if (this->_not) out += "!";
-        out += this->_id;
-        return out;
+    void print(Sink &out, bool a) const {
+        if (this->_not) out << '!';
+        out << *this->_name;
     }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    virtual vset getvs(void) { vset n; n.insert(this->_id); return n; }
+    virtual void dflocals(DFLocals &f) const;
 
-    virtual void emitrd(void) const {
-        std::cout << this->str(false);
+    virtual void flatten(FlatAST &f) const {
+        f.leaf(FLAT_IDENT, this->_var, this->_not);
     }
 };
 
@@ -165,15 +259,16 @@ public:
 
     ~Int(void) { ; }
 
-    Int(std::string svalue) :
-        Expression(), _value(Base::string2int(svalue)) { ; }
+    Int(int value) : Expression(), _value(value) { ; }
 
-    std::string str(bool a) const { return Base::int2string(this->_value); }
+    virtual FlatKind kind(void) const { return FLAT_INT; }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    void print(Sink &out, bool a) const { out << this->_value; }
 
-    virtual void emitrd(void) const {
-        std::cout << this->str(false);
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
+
+    virtual void flatten(FlatAST &f) const {
+        f.leaf(FLAT_INT, uint32_t(this->_value));
     }
 };
 
@@ -187,16 +282,17 @@ public:
 
     ~Float(void) { ; }
 
-    Float(std::string svalue) :
-        Expression(), _value(Base::string2float(svalue)) { ; }
-
-    std::string str(bool a) const { return Base::float2string(this->_value); }
+    Float(float value) : Expression(), _value(value) { ; }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual FlatKind kind(void) const { return FLAT_FLOAT; }
 
-    virtual void emitrd(void) const {
-        std::cout << this->str(false);
+    void print(Sink &out, bool a) const {
+        out << Base::float2string(this->_value);
     }
+
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
+
+    virtual void flatten(FlatAST &f) const;
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -209,34 +305,42 @@ public:
 
     ~Logical(void) { ; }
 
-    Logical(const std::string &svalue) : _value(Base::string2bool(svalue)) { ; }
+    Logical(bool value) : Expression(), _value(value) { ; }
+
+    virtual FlatKind kind(void) const { return FLAT_LOGICAL; }
 
-    std::string str(bool a) const {
-        std::string out;
-        if (this->_not) out += "!";
-        out += Base::bool2string(this->_value);
-        return out;
+    void print(Sink &out, bool a) const {
+        if (this->_not) out << '!';
+        out << (this->_value ? "true" : "false");
     }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    virtual void emitrd(void) const {
-        std::cout << this->str(false);
+    virtual void flatten(FlatAST &f) const {
+        f.leaf(FLAT_LOGICAL, this->_value, this->_not);
     }
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
 class AssignmentExpression : public Expression {
 private:
+    /* target variable */
+    varid _var;
+    /* definition index */
+    size_t _gen;
+    /* all definitions of the target variable */
+    const BitVector *_kill;
 
 public:
-    AssignmentExpression(void) { ; }
+    AssignmentExpression(void) : _var(0), _gen(0), _kill(NULL) { ; }
 
     ~AssignmentExpression(void) { ; }
 
     AssignmentExpression(Identifier *id, Expression *expr);
 
-    std::string str(bool a) const;
+    virtual FlatKind kind(void) const { return FLAT_ASSIGN; }
+
+    void print(Sink &out, bool a) const;
 
     virtual int label(void) const { return this->_label; }
 
@@ -247,32 +351,44 @@ public:
         if (this->r) this->r->label(label);
     }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
-
-    virtual void cfgPrep(Painter *p);
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
     virtual bool rdgo(const vlabmap &in, vlabmap &out);
+    /* register this definition site with t */
+    void rdprep(DefTable &t);
+
+    void rdbind(size_t gen, const BitVector *kill) {
+        this->_gen = gen;
+        this->_kill = kill;
+    }
+
+    virtual bool rdgobv(const BitVector &in, BitVector &out);
 
-    virtual void emitrd(void) const {
-        std::cout << this->str(false);
+    virtual void rdsummary(BitVector &gen, BitVector &kill) {
+        gen.set(this->_gen);
+        kill = *this->_kill;
     }
+
+    virtual void dflocals(DFLocals &f) const;
+
+    virtual void flatten(FlatAST &f) const;
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
 class ArithmeticExpression : public Expression {
 private:
-    std::string _op;
+    BinOp _op;
 
 public:
-    ArithmeticExpression(void) { ; }
+    ArithmeticExpression(void) : _op(OP_ADD) { ; }
 
     ~ArithmeticExpression(void) { ; }
 
-    ArithmeticExpression(Expression *l,
-                         std::string *op,
-                         Expression *r);
+    ArithmeticExpression(Expression *l, BinOp op, Expression *r);
+
+    virtual FlatKind kind(void) const { return FLAT_ARITH; }
 
-    std::string str(bool a) const;
+    void print(Sink &out, bool a) const;
 
     virtual int label(void) const { return this->_label; }
 
@@ -282,28 +398,28 @@ public:
         if (this->r) this->r->label(label);
     }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    virtual void emitrd(void) const {
-        std::cout << this->str(false);
-    }
+    virtual void dflocals(DFLocals &f) const;
+
+    virtual void flatten(FlatAST &f) const;
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
 class LogicalExpression : public Expression {
 private:
-    std::string _op;
+    BinOp _op;
 
 public:
     LogicalExpression(void);
 
     virtual ~LogicalExpression(void) { ; }
 
-    LogicalExpression(Expression *l,
-                      std::string *op,
-                      Expression *r);
+    LogicalExpression(Expression *l, BinOp op, Expression *r);
+
+    virtual FlatKind kind(void) const { return FLAT_LOGIC; }
 
-    std::string str(bool a) const;
+    void print(Sink &out, bool a) const;
 
     virtual int label(void) const { return this->_label; }
 
@@ -313,15 +429,9 @@ public:
         if (this->r) this->r->label(label);
     }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    virtual void cfgPrep(Painter *p);
-
-    virtual bool rdgo(const vlabmap &in, vlabmap &out);
-
-    virtual void emitrd(void) const {
-        std::cout << this->str(false);
-    }
+    virtual void flatten(FlatAST &f) const;
 };
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -329,14 +439,8 @@ class Statement : public Node {
 protected:
     bool _exprStatement;
     Expression *_expr;
-    std::string _meta;
 
 public:
-    /* nodes 1 */
-    std::vector<void *> aNodes;
-    /* nodes 2 */
-    std::vector<void *> bNodes;
-
     Statement(void) :
         _exprStatement(false), _expr(NULL) { ; }
 
@@ -344,7 +448,11 @@ public:
 
     Statement(Expression *expression);
 
-    virtual std::string str(bool a) const;
+    virtual FlatKind kind(void) const {
+        return this->_exprStatement ? FLAT_TEST : FLAT_STMT;
+    }
+
+    virtual void print(Sink &out, bool a) const;
 
     virtual bool exprStatement(void) const { return this->_exprStatement; }
 
@@ -357,34 +465,42 @@ public:
         if (this->_expr) this->_expr->label(label);
     }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const {
+    virtual void buildAST(Painter *p, PNode e, bool a) const {
         this->_expr->buildAST(p, e, a);
     }
 
-    virtual std::string meta(void) const { return this->_meta; }
+    virtual bool whilestmt(void) const { return false; }
+
+    virtual bool ifstmt(void) const { return false; }
 
-    virtual void meta(std::string m) { this->_meta = m; }
+    virtual void cfgPrep(CFG &g) {
+        this->_cfgnode = g.newNode(CFG_STMT, this);
+    }
+    /* text of this statement's control flow graph node */
+    virtual std::string cfglabel(void) const { return this->_expr->str(false); }
 
-    virtual bool whilestmt(void) const { return this->_meta == "while"; }
+    virtual bool rdgo(const vlabmap &in, vlabmap &out);
 
-    virtual bool ifstmt(void) const { return this->_meta == "if"; }
+    virtual bool rdgobv(const BitVector &in, BitVector &out);
 
-    virtual void cfgPrep(Painter *p) {
-        this->_expr->cfgPrep(p);
-        this->_cfgnode = this->_expr->cfgnode();
+    virtual void rdsummary(BitVector &gen, BitVector &kill) {
+        this->_expr->rdsummary(gen, kill);
     }
-    void cfgStitch(Painter *p, void *in, void **out);
 
-    virtual vset getvs(void);
+    virtual void rdpropagate(const BitVector &in, BitVector &out);
 
-    virtual bool rdgo(const vlabmap &in, vlabmap &out);
+    virtual void dflocals(DFLocals &f) const {
+        if (this->_expr) this->_expr->dflocals(f);
+    }
+
+    virtual void flatten(FlatAST &f) const;
 
-    virtual void emitrd(void) const {
-        Node::emitVLabSet(this->_entry);
-        std::cout << "[";
-        this->_expr->emitrd();
-        std::cout << "] -- " << this->label() << std::endl;
-        Node::emitVLabSet(this->_exit);
+    virtual void emitrd(Sink &out, const SymbolTable &syms) const {
+        Node::emitVLabSet(out, syms, this->_entry);
+        out << "[";
+        this->_expr->emitrd(out, syms);
+        out << "] -- " << this->label() << '\n';
+        Node::emitVLabSet(out, syms, this->_exit);
     }
 };
 typedef std::vector<Statement> Statements;
@@ -396,17 +512,32 @@ private:
     static const int ndias;
     static const std::string diaNames[];
 
+    /* last label handed out inside this block */
+    int _end;
+    /* program block only: variables are ids [0, _nvars) */
+    varid _nvars;
+    /* program block only: every assignment, in source order */
+    std::vector<AssignmentExpression *> _defsites;
+
+    void rdsummary(size_t b, size_t e, BitVector &gen, BitVector &kill);
+
 protected:
     Statementps _statements;
 
 public:
-    Block(void) { ; }
+    Block(void) : _end(0), _nvars(0) { ; }
 
     virtual ~Block(void) { ; }
 
     virtual void add(Statement *s) { this->_statements.push_back(s); }
 
-    virtual std::string str(bool a) const;
+    virtual FlatKind kind(void) const { return FLAT_BLOCK; }
+
+    virtual unsigned nkids(void) const { return this->_statements.size(); }
+
+    virtual Node *kid(unsigned i) const { return this->_statements[i]; }
+
+    virtual void print(Sink &out, bool a) const;
 
     virtual unsigned depth(void) const { return Node::depth(); }
 
@@ -415,32 +546,72 @@ public:
     virtual int label(void) const { return this->_label; }
 
     virtual void label(int &label);
+    /* labels (label, end] are the ones inside */
+    void span(int label, int end) {
+        this->_label = label;
+        this->_end = end;
+    }
+    /* number of labels inside, a rough measure of analysis cost */
+    size_t weight(void) const { return this->_end - this->_label; }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    void drawASTs(std::string fprefix, std::string type);
+    /* the drawings are only built here. render them with renderAST. */
+    void drawASTs(std::string fprefix, std::string type, Paintings &out);
 
-    void drawCFG(std::string fprefix, std::string type);
+    void drawCFG(std::string fprefix, std::string type, Paintings &out);
 
     unsigned nstatements(void) const { return this->_statements.size(); }
 
-    virtual void cfgPrep(Painter *p);
+    Statement *statement(unsigned i) const { return this->_statements[i]; }
+    /* build the control flow graph of the whole block */
+    void buildCFG(CFG &g);
+
+    /* takes the definition sites the parser recorded */
+    void defsites(std::vector<AssignmentExpression *> &d) {
+        this->_defsites.swap(d);
+    }
+    /* the parser interns every variable it sees, so the symbol table already
+     * is the variable index */
+    void gatherVars(const SymbolTable &syms) { this->_nvars = syms.size(); }
 
-    virtual void cfgStitch(Painter *p, void *in, void **out);
+    unsigned nvars(void) const { return this->_nvars; }
 
-    virtual vset getvs(void);
+    void emitVars(std::ostream &os, const SymbolTable &syms) const {
+        Node::emitVars(os, syms, this->_nvars);
+    }
 
-    void gatherVars(void) { this->_vars = this->getvs(); }
+    vlabmap genStartSet(void) const;
 
-    void rdcalc(void);
+    /* for RD_ENGINE_PARALLEL, nthreads is the number of slices. the map,
+     * bitvec and region engines fork if branches and block halves weighing
+     * at least forkmin onto nthreads workers. */
+    void rdcalc(std::ostream &os,
+                const SymbolTable &syms,
+                RDEngine engine = RD_ENGINE_MAP,
+                unsigned nthreads = 1,
+                size_t forkmin = 0);
+
+    /* solves analysis a over the control flow graph and prints its entry and
+     * exit sets */
+    void dfcalc(std::ostream &os, const SymbolTable &syms, DFAnalysis a);
 
     bool rdgo(const vlabmap &in, vlabmap &out);
 
-    virtual void emitrd(void) const {
-        for (Statement *s : this->_statements) {
-            s->emitrd();
-        }
-    }
+    bool rdgobv(const BitVector &in, BitVector &out);
+
+    virtual void rdsync(const DefTable &t);
+
+    virtual void rdsummary(BitVector &gen, BitVector &kill);
+    /* summarizes statements [b, e) as two halves side by side if the range
+     * is heavy enough to fork. returns false, having done nothing, if not. */
+    bool rdsummaryFork(size_t b, size_t e, BitVector &gen, BitVector &kill);
+
+    virtual void rdpropagate(const BitVector &in, BitVector &out);
+
+    virtual void flatten(FlatAST &f) const;
+
+    virtual void emitrd(Sink &out, const SymbolTable &syms) const;
 };
 typedef std::vector<Block> Blocks;
 
@@ -452,22 +623,31 @@ public:
 
     virtual ~Skip(void) { ; }
 
-    std::string str(bool a) const;
+    virtual FlatKind kind(void) const { return FLAT_SKIP; }
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    void print(Sink &out, bool a) const;
 
-    virtual void cfgPrep(Painter *p);
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    virtual vset getvs(void) {
-        vset bogus; bogus.insert(Node::BOGUS_VAR); return bogus;
-    }
+    virtual std::string cfglabel(void) const { return "skip"; }
+
+    virtual void flatten(FlatAST &f) const { f.leaf(FLAT_SKIP); }
 
     bool rdgo(const vlabmap &in, vlabmap &out);
 
-    virtual void emitrd(void) const {
-        Node::emitVLabSet(this->_entry);
-        std::cout << "skip" << std::endl;
-        Node::emitVLabSet(this->_exit);
+    bool rdgobv(const BitVector &in, BitVector &out);
+
+    virtual void rdsummary(BitVector &gen, BitVector &kill) { ; }
+
+    virtual void rdpropagate(const BitVector &in, BitVector &out) {
+        this->rdbits(in, in);
+        out = in;
+    }
+
+    virtual void emitrd(Sink &out, const SymbolTable &syms) const {
+        Node::emitVLabSet(out, syms, this->_entry);
+        out << "skip\n";
+        Node::emitVLabSet(out, syms, this->_exit);
     }
 };
 
@@ -486,7 +666,16 @@ public:
 
     IfStatement(Block *expr, Block *ifBlock, Block *elseBlock);
 
-    std::string str(bool a) const;
+    virtual FlatKind kind(void) const { return FLAT_IF; }
+
+    virtual unsigned nkids(void) const { return 3; }
+
+    virtual Node *kid(unsigned i) const {
+        return 0 == i ? this->_exprBlock :
+               1 == i ? this->_ifBlock : this->_elseBlock;
+    }
+
+    void print(Sink &out, bool a) const;
 
     virtual unsigned depth(void) const { return this->_depth; }
 
@@ -496,27 +685,42 @@ public:
 
     virtual void label(int &label);
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    virtual void cfgPrep(Painter *p);
+    virtual bool ifstmt(void) const { return true; }
 
-    virtual void cfgStitch(Painter *p, void *in, void **out);
+    virtual void cfgPrep(CFG &g);
 
-    virtual vset getvs(void);
+    virtual std::string cfglabel(void) const {
+        return "while " + this->_exprBlock->str(false);
+    }
+
+    /* the lighter branch bounds what running them side by side can save */
+    size_t weight(void) const {
+        return std::min(this->_ifBlock->weight(), this->_elseBlock->weight());
+    }
 
     bool rdgo(const vlabmap &in, vlabmap &out);
 
-    virtual void emitrd(void) const {
-        this->_exprBlock->emitrd();
-        this->_ifBlock->emitrd();
-        this->_elseBlock->emitrd();
-    }
+    bool rdgobv(const BitVector &in, BitVector &out);
+
+    virtual void rdsync(const DefTable &t);
+
+    virtual void rdsummary(BitVector &gen, BitVector &kill);
+
+    virtual void rdpropagate(const BitVector &in, BitVector &out);
+
+    virtual void flatten(FlatAST &f) const;
+
+    virtual void emitrd(Sink &out, const SymbolTable &syms) const;
 };
 
 class WhileStatement : public Statement {
 private:
     Block *_exprBlock;
     Block *_bodyBlock;
+    /* definitions that survive one trip through the body */
+    BitVector _bodyGen;
 
 public:
     WhileStatement(void) { ; }
@@ -525,7 +729,15 @@ public:
 
     WhileStatement(Block *expr, Block *bodyBlock);
 
-    std::string str(bool a) const;
+    virtual FlatKind kind(void) const { return FLAT_WHILE; }
+
+    virtual unsigned nkids(void) const { return 2; }
+
+    virtual Node *kid(unsigned i) const {
+        return 0 == i ? this->_exprBlock : this->_bodyBlock;
+    }
+
+    void print(Sink &out, bool a) const;
 
     virtual unsigned depth(void) const { return this->_depth; }
 
@@ -535,21 +747,31 @@ public:
 
     virtual void label(int &label);
 
-    virtual void buildAST(Painter *p, void *e, bool a) const;
+    virtual void buildAST(Painter *p, PNode e, bool a) const;
 
-    virtual void cfgPrep(Painter *p);
+    virtual bool whilestmt(void) const { return true; }
 
-    virtual void cfgStitch(Painter *p, void *in, void **out);
+    virtual void cfgPrep(CFG &g);
 
-    virtual vset getvs(void);
+    virtual std::string cfglabel(void) const {
+        return "while " + this->_exprBlock->str(false);
+    }
 
     virtual bool rdgo(const vlabmap &in, vlabmap &out);
 
-    virtual void emitrd(void) const {
-        this->_exprBlock->emitrd();
-        this->_bodyBlock->emitrd();
-        Node::emitVLabSet(this->_exit);
-    }
+    virtual bool rdgobv(const BitVector &in, BitVector &out);
+
+    virtual void rdsync(const DefTable &t);
+
+    virtual void rdsummary(BitVector &gen, BitVector &kill);
+
+    virtual void rdpropagate(const BitVector &in, BitVector &out);
+    /* definitions rdsummary found surviving one trip through the body */
+    BitVector &bodyGen(void) { return this->_bodyGen; }
+
+    virtual void flatten(FlatAST &f) const;
+
+    virtual void emitrd(Sink &out, const SymbolTable &syms) const;
 };
 
 #endif
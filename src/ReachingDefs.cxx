@@ -0,0 +1,340 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ReachingDefs.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <thread>
+
+using namespace std;
+
+const size_t DefTable::NONE = ~size_t(0);
+
+/* ////////////////////////////////////////////////////////////////////////// */
+DefTable::DefTable(varid nvars)
+{
+    this->_sealed = false;
+    for (varid v = 0; v < nvars; ++v) {
+        this->_defs.push_back(RDef(v, -1, NULL));
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+DefTable::add(varid var, int label, AssignmentExpression *site)
+{
+    if (this->_sealed) {
+        throw DFlowException(DFLOW_WHERE, "definition added to sealed table");
+    }
+    this->_defs.push_back(RDef(var, label, site));
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+DefTable::seal(void)
+{
+    sort(this->_defs.begin(), this->_defs.end());
+
+    varid nvars = this->_defs.empty() ? 0 : this->_defs.back().var + 1;
+    this->_kills.assign(nvars, BitVector(this->_defs.size()));
+    for (size_t i = 0; i < this->_defs.size(); ++i) {
+        this->_kills[this->_defs[i].var].set(i);
+    }
+    for (size_t i = 0; i < this->_defs.size(); ++i) {
+        const RDef &d = this->_defs[i];
+        if (d.site) d.site->rdbind(i, &this->_kills[d.var]);
+        if (-1 != d.label) this->_bylabel[d.label] = i;
+    }
+    this->_sealed = true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+size_t
+DefTable::defAt(int label) const
+{
+    auto d = this->_bylabel.find(label);
+    return this->_bylabel.end() == d ? DefTable::NONE : d->second;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+const BitVector &
+DefTable::kill(size_t i) const
+{
+    return this->_kills[this->_defs[i].var];
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+BitVector
+DefTable::startSet(void) const
+{
+    BitVector s(this->_defs.size());
+    for (size_t i = 0; i < this->_defs.size(); ++i) {
+        if (-1 == this->_defs[i].label) s.set(i);
+    }
+    return s;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+vlabmap
+DefTable::toMap(const BitVector &b) const
+{
+    vlabmap m;
+    for (size_t i = b.next(0); i < b.size(); i = b.next(i + 1)) {
+        m.insert(m.end(), make_pair(this->_defs[i].var, this->_defs[i].label));
+    }
+    return m;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+RDWorklist::RDWorklist(const CFG &g, const DefTable &defs) :
+    _g(g), _defs(defs), _visits(0), _nslices(0)
+{
+    unsigned nn = g.size();
+
+    this->_gen.assign(nn, DefTable::NONE);
+    this->_kill.assign(nn, NULL);
+    for (unsigned n = 0; n < nn; ++n) {
+        if (CFG_STMT != g.node(n).kind) continue;
+        size_t d = defs.defAt(g.node(n).label);
+        if (DefTable::NONE == d) continue;
+        this->_gen[n] = d;
+        this->_kill[n] = &defs.kill(d);
+    }
+    this->_in.assign(nn, BitVector(defs.size()));
+    this->_out.assign(nn, BitVector(defs.size()));
+    reversePostorder(g, g.entry(), this->_order, this->_rpo);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* runs the worklist over words [w0, w1) of every set only. the transfer
+ * functions are bitwise, so one slice never reads another's words, and each
+ * slice can stop as soon as its own words are stable. returns the number of
+ * node visits. */
+unsigned long
+RDWorklist::solveWords(const BitVector &start, size_t w0, size_t w1)
+{
+    const CFG &g = this->_g;
+    const size_t nw = w1 - w0;
+    /* keyed by reverse postorder number */
+    priority_queue<unsigned, vector<unsigned>, greater<unsigned> > work;
+    vector<bool> queued(this->_order.size(), true);
+    vector<uint64_t> tmp(nw);
+    unsigned long visits = 0;
+
+    for (unsigned i = 0; i < this->_order.size(); ++i) work.push(i);
+
+    while (!work.empty()) {
+        unsigned n = this->_order[work.top()];
+        queued[work.top()] = false;
+        work.pop();
+        ++visits;
+        /* meet */
+        if (g.entry() == n) {
+            for (size_t w = 0; w < nw; ++w) tmp[w] = start.word(w0 + w);
+        }
+        else {
+            for (size_t w = 0; w < nw; ++w) tmp[w] = 0;
+            for (unsigned p = 0; p < g.npreds(n); ++p) {
+                const BitVector &o = this->_out[g.preds(n)[p]];
+                for (size_t w = 0; w < nw; ++w) tmp[w] |= o.word(w0 + w);
+            }
+        }
+        BitVector &in = this->_in[n];
+        for (size_t w = 0; w < nw; ++w) in.word(w0 + w) = tmp[w];
+        /* transfer */
+        size_t d = this->_gen[n];
+        if (DefTable::NONE != d) {
+            const BitVector &k = *this->_kill[n];
+            for (size_t w = 0; w < nw; ++w) tmp[w] &= ~k.word(w0 + w);
+            if (d / 64 >= w0 && d / 64 < w1) {
+                tmp[d / 64 - w0] |= uint64_t(1) << (d % 64);
+            }
+        }
+        BitVector &out = this->_out[n];
+        bool changed = false;
+        for (size_t w = 0; w < nw; ++w) {
+            if (out.word(w0 + w) != tmp[w]) {
+                out.word(w0 + w) = tmp[w];
+                changed = true;
+            }
+        }
+        if (!changed) continue;
+        for (unsigned s = 0; s < g.nsuccs(n); ++s) {
+            unsigned r = this->_rpo[g.succs(n)[s]];
+            if (CFG::NONE != r && !queued[r]) {
+                queued[r] = true;
+                work.push(r);
+            }
+        }
+    }
+    return visits;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* definitions are numbered in (var, label) order, so a word range of the sets
+ * is a range of variables (give or take one split at each end). nslices
+ * threads each solve one range over the same graph. */
+void
+RDWorklist::solve(const BitVector &start, unsigned nslices)
+{
+    const size_t nw = start.nwords();
+
+    if (nslices > nw) nslices = unsigned(nw);
+    if (nslices < 1) nslices = 1;
+    this->_nslices = nslices;
+    if (1 == nslices) {
+        this->_visits += this->solveWords(start, 0, nw);
+        return;
+    }
+    vector<unsigned long> visits(nslices, 0);
+    vector<thread> workers;
+    workers.reserve(nslices);
+    for (unsigned t = 0; t < nslices; ++t) {
+        size_t w0 = nw * t / nslices, w1 = nw * (t + 1) / nslices;
+        workers.push_back(thread([this, &start, &visits, t, w0, w1] {
+            visits[t] = this->solveWords(start, w0, w1);
+        }));
+    }
+    for (auto &w : workers) w.join();
+    for (auto v : visits) this->_visits += v;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+RDWorklist::publish(void) const
+{
+    for (unsigned n = 0; n < this->_g.size(); ++n) {
+        const CFGNode &node = this->_g.node(n);
+        switch (node.kind) {
+            case CFG_STMT:
+            case CFG_TEST:
+                node.stmt->rdbits(this->_in[n], this->_out[n]);
+                break;
+            case CFG_MERGE:
+                node.owner->rdbits(this->_in[n], this->_out[n]);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+RDBlocks::RDBlocks(const BasicBlocks &bbs, const DefTable &defs) :
+    _bbs(bbs), _defs(defs), _visits(0)
+{
+    const CFG &g = bbs.cfg();
+    unsigned nb = bbs.size();
+
+    this->_gen.assign(nb, BitVector(defs.size()));
+    this->_kill.assign(nb, BitVector(defs.size()));
+    /* compose the statements of each block, first to last */
+    for (unsigned b = 0; b < nb; ++b) {
+        for (unsigned i = 0; i < bbs.nnodes(b); ++i) {
+            const CFGNode &node = g.node(bbs.nodes(b)[i]);
+            if (CFG_STMT != node.kind) continue;
+            size_t d = defs.defAt(node.label);
+            if (DefTable::NONE == d) continue;
+            this->_gen[b].andNot(defs.kill(d));
+            this->_gen[b].set(d);
+            this->_kill[b] |= defs.kill(d);
+        }
+    }
+    this->_in.assign(nb, BitVector(defs.size()));
+    this->_out.assign(nb, BitVector(defs.size()));
+    reversePostorder(bbs, bbs.entry(), this->_order, this->_rpo);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+RDBlocks::solve(const BitVector &start)
+{
+    const BasicBlocks &bbs = this->_bbs;
+    priority_queue<unsigned, vector<unsigned>, greater<unsigned> > work;
+    vector<bool> queued(this->_order.size(), true);
+    BitVector tmp(this->_defs.size());
+
+    for (unsigned i = 0; i < this->_order.size(); ++i) work.push(i);
+
+    while (!work.empty()) {
+        unsigned b = this->_order[work.top()];
+        queued[work.top()] = false;
+        work.pop();
+        ++this->_visits;
+        if (bbs.entry() == b) {
+            tmp = start;
+        }
+        else {
+            tmp.clear();
+        }
+        for (unsigned p = 0; p < bbs.npreds(b); ++p) {
+            tmp |= this->_out[bbs.preds(b)[p]];
+        }
+        this->_in[b] = tmp;
+        tmp.andNot(this->_kill[b]);
+        tmp |= this->_gen[b];
+        if (tmp == this->_out[b]) continue;
+        this->_out[b] = tmp;
+        for (unsigned s = 0; s < bbs.nsuccs(b); ++s) {
+            unsigned r = this->_rpo[bbs.succs(b)[s]];
+            if (CFG::NONE != r && !queued[r]) {
+                queued[r] = true;
+                work.push(r);
+            }
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+RDBlocks::publish(void) const
+{
+    const CFG &g = this->_bbs.cfg();
+    BitVector in, out;
+
+    for (unsigned b = 0; b < this->_bbs.size(); ++b) {
+        out = this->_in[b];
+        for (unsigned i = 0; i < this->_bbs.nnodes(b); ++i) {
+            const CFGNode &node = g.node(this->_bbs.nodes(b)[i]);
+            in = out;
+            if (CFG_STMT == node.kind) {
+                size_t d = this->_defs.defAt(node.label);
+                if (DefTable::NONE != d) {
+                    out.andNot(this->_defs.kill(d));
+                    out.set(d);
+                }
+            }
+            switch (node.kind) {
+                case CFG_STMT:
+                case CFG_TEST:
+                    node.stmt->rdbits(in, out);
+                    break;
+                case CFG_MERGE:
+                    node.owner->rdbits(in, out);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
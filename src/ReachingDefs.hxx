@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REACHING_DEFS_H_INCLUDED
+#define REACHING_DEFS_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "BasicBlocks.hxx"
+#include "BitVector.hxx"
+#include "CFG.hxx"
+#include "Program.hxx"
+
+#include <string>
+#include <vector>
+#include <map>
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* a single definition. label -1 means "undefined on entry." */
+struct RDef {
+    varid var;
+    int label;
+    AssignmentExpression *site;
+
+    RDef(varid v, int l, AssignmentExpression *s) :
+        var(v), label(l), site(s) { ; }
+
+    bool operator<(const RDef &o) const {
+        return this->var < o.var || (this->var == o.var &&
+                                     this->label < o.label);
+    }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* maps definitions to dense bit indices. definitions are numbered in (var,
+ * label) order, so set bits enumerate in the same order as a vlabmap. */
+class DefTable {
+private:
+    /* index -> definition */
+    std::vector<RDef> _defs;
+    /* variable -> all of its definitions */
+    std::vector<BitVector> _kills;
+    /* label -> definition made there */
+    std::map<int, size_t> _bylabel;
+    bool _sealed;
+
+    DefTable(void);
+
+public:
+    /* starts with an undefined-on-entry definition of every id below nvars */
+    DefTable(varid nvars);
+
+    ~DefTable(void) { ; }
+
+    void add(varid var, int label, AssignmentExpression *site);
+    /* number definitions and bind gen/kill sets to their sites */
+    void seal(void);
+
+    size_t size(void) const { return this->_defs.size(); }
+
+    static const size_t NONE;
+
+    const RDef &def(size_t i) const { return this->_defs[i]; }
+    /* the definition made at label, or NONE */
+    size_t defAt(int label) const;
+    /* all definitions of def i's variable */
+    const BitVector &kill(size_t i) const;
+
+    BitVector startSet(void) const;
+
+    vlabmap toMap(const BitVector &b) const;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* worklist reaching definitions over a control flow graph. nodes are only
+ * revisited when one of their predecessors changed, lowest reverse postorder
+ * number first. */
+class RDWorklist {
+private:
+    const CFG &_g;
+    const DefTable &_defs;
+    /* per-node transfer function */
+    std::vector<size_t> _gen;
+    std::vector<const BitVector *> _kill;
+    /* per-node results */
+    std::vector<BitVector> _in, _out;
+    /* reverse postorder number of each node, and its inverse */
+    std::vector<unsigned> _rpo, _order;
+    unsigned long _visits;
+    /* number of independent slices the last solve was split into */
+    unsigned _nslices;
+
+    RDWorklist(void);
+
+    unsigned long solveWords(const BitVector &start, size_t w0, size_t w1);
+
+public:
+    RDWorklist(const CFG &g, const DefTable &defs);
+
+    ~RDWorklist(void) { ; }
+
+    /* splits the definitions into up to nslices ranges solved concurrently */
+    void solve(const BitVector &start, unsigned nslices = 1);
+
+    unsigned long visits(void) const { return this->_visits; }
+
+    unsigned nslices(void) const { return this->_nslices; }
+
+    const BitVector &in(unsigned n) const { return this->_in[n]; }
+
+    const BitVector &out(unsigned n) const { return this->_out[n]; }
+    /* hand results to the statements so rdsync and emitrd can use them */
+    void publish(void) const;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* worklist reaching definitions over basic blocks. each block is summarized
+ * by one gen/kill pair, so the fixed point iteration touches one node per
+ * block. per-statement sets are rebuilt by publish with a forward sweep. */
+class RDBlocks {
+private:
+    const BasicBlocks &_bbs;
+    const DefTable &_defs;
+    /* per-block summaries */
+    std::vector<BitVector> _gen, _kill;
+    /* per-block results */
+    std::vector<BitVector> _in, _out;
+    std::vector<unsigned> _rpo, _order;
+    unsigned long _visits;
+
+    RDBlocks(void);
+
+public:
+    RDBlocks(const BasicBlocks &bbs, const DefTable &defs);
+
+    ~RDBlocks(void) { ; }
+
+    void solve(const BitVector &start);
+
+    unsigned long visits(void) const { return this->_visits; }
+
+    void publish(void) const;
+};
+
+#endif
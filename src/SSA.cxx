@@ -0,0 +1,439 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SSA.hxx"
+#include "Analyses.hxx"
+#include "Program.hxx"
+
+#include <algorithm>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+SSAForm::SSAForm(const CFG &g, const DefTable &defs) :
+    _g(g), _defs(defs), _nvars(0), _phi0(0), _visits(0)
+{
+    unsigned nn = g.size();
+
+    /* the table starts every variable with an undefined-on-entry definition,
+     * and those sort first, so value v is variable v on entry */
+    for (size_t i = 0; i < defs.size(); ++i) {
+        const RDef &d = defs.def(i);
+        if (-1 != d.label) continue;
+        this->_values.push_back(SSAValue(d.var, g.entry(), i));
+    }
+    this->_nvars = this->_values.size();
+    this->_defval.assign(nn, CFG::NONE);
+    this->_useoff.assign(nn + 1, 0);
+    for (unsigned n = 0; n < nn; ++n) {
+        const CFGNode &node = g.node(n);
+        this->_useoff[n] = this->_usevar.size();
+        if (CFG_STMT != node.kind && CFG_TEST != node.kind) continue;
+        size_t d = defs.defAt(node.label);
+        if (CFG_STMT == node.kind && DefTable::NONE != d) {
+            this->_defval[n] = this->_values.size();
+            this->_values.push_back(SSAValue(defs.def(d).var, n, d));
+        }
+        /* each variable read counts once per node */
+        DFLocals f;
+        node.stmt->dflocals(f);
+        sort(f.uses.begin(), f.uses.end());
+        f.uses.erase(unique(f.uses.begin(), f.uses.end()), f.uses.end());
+        this->_usevar.insert(this->_usevar.end(), f.uses.begin(), f.uses.end());
+    }
+    this->_useoff[nn] = this->_usevar.size();
+    this->_useval.assign(this->_usevar.size(), CFG::NONE);
+
+    this->dominators();
+    this->placePhis();
+    this->rename();
+    this->chains();
+
+    this->_reach.resize(this->_values.size());
+    for (unsigned v = 0; v < this->_phi0; ++v) {
+        this->_reach[v].push_back(this->_values[v].def);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* iterative dominators over reverse postorder (cooper, harvey and kennedy) */
+void
+SSAForm::dominators(void)
+{
+    const CFG &g = this->_g;
+    vector<unsigned> order, rpo;
+    vector<unsigned> &idom = this->_idom;
+
+    reversePostorder(g, g.entry(), order, rpo);
+    idom.assign(g.size(), CFG::NONE);
+    idom[g.entry()] = g.entry();
+    for (bool changed = true; changed; ) {
+        changed = false;
+        for (unsigned i = 1; i < order.size(); ++i) {
+            unsigned n = order[i], d = CFG::NONE;
+            for (unsigned p = 0; p < g.npreds(n); ++p) {
+                unsigned b = g.preds(n)[p];
+                if (CFG::NONE == idom[b]) continue;
+                if (CFG::NONE == d) {
+                    d = b;
+                    continue;
+                }
+                while (b != d) {
+                    while (rpo[b] > rpo[d]) b = idom[b];
+                    while (rpo[d] > rpo[b]) d = idom[d];
+                }
+            }
+            if (d != idom[n]) {
+                idom[n] = d;
+                changed = true;
+            }
+        }
+    }
+    /* children lists */
+    this->_doff.assign(g.size() + 1, 0);
+    for (unsigned n = 0; n < g.size(); ++n) {
+        if (CFG::NONE != idom[n] && g.entry() != n) ++this->_doff[idom[n]];
+    }
+    for (unsigned n = 0, sum = 0; n <= g.size(); ++n) {
+        unsigned c = this->_doff[n];
+        this->_doff[n] = sum;
+        sum += c;
+    }
+    this->_dkids.resize(this->_doff[g.size()]);
+    vector<unsigned> fill(this->_doff.begin(), this->_doff.end() - 1);
+    for (unsigned n = 0; n < g.size(); ++n) {
+        if (CFG::NONE == idom[n] || g.entry() == n) continue;
+        this->_dkids[fill[idom[n]]++] = n;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* minimal ssa: a variable gets a phi on the iterated dominance frontier of
+ * its assignments. every variable is also defined at the entry, whose
+ * frontier is empty. */
+void
+SSAForm::placePhis(void)
+{
+    const CFG &g = this->_g;
+    const unsigned nn = g.size();
+    vector<vector<unsigned> > df(nn);
+    vector<vector<varid> > phivars(nn);
+
+    for (unsigned n = 0; n < nn; ++n) {
+        if (g.npreds(n) < 2 || CFG::NONE == this->_idom[n]) continue;
+        for (unsigned p = 0; p < g.npreds(n); ++p) {
+            unsigned r = g.preds(n)[p];
+            if (CFG::NONE == this->_idom[r]) continue;
+            while (r != this->_idom[n]) {
+                if (df[r].empty() || df[r].back() != n) df[r].push_back(n);
+                r = this->_idom[r];
+            }
+        }
+    }
+    /* assignment nodes by variable */
+    vector<vector<unsigned> > sites(this->_nvars);
+    for (unsigned v = this->_nvars; v < this->_values.size(); ++v) {
+        sites[this->_values[v].var].push_back(this->_values[v].node);
+    }
+    /* last variable that put node n on the work list or gave it a phi, + 1 */
+    vector<size_t> queued(nn, 0), placed(nn, 0);
+    vector<unsigned> work;
+    for (varid v = 0; v < this->_nvars; ++v) {
+        work = sites[v];
+        for (unsigned n : work) queued[n] = v + 1;
+        while (!work.empty()) {
+            unsigned x = work.back();
+            work.pop_back();
+            for (unsigned y : df[x]) {
+                if (v + 1 == placed[y]) continue;
+                placed[y] = v + 1;
+                phivars[y].push_back(v);
+                if (v + 1 != queued[y]) {
+                    queued[y] = v + 1;
+                    work.push_back(y);
+                }
+            }
+        }
+    }
+    /* phis of a node are contiguous */
+    this->_phi0 = this->_values.size();
+    this->_phioff.assign(nn + 1, 0);
+    this->_argoff.assign(1, 0);
+    for (unsigned n = 0; n < nn; ++n) {
+        this->_phioff[n] = this->_values.size();
+        for (varid v : phivars[n]) {
+            this->_values.push_back(SSAValue(v, n, DefTable::NONE));
+            this->_argoff.push_back(this->_argoff.back() + g.npreds(n));
+        }
+    }
+    this->_phioff[nn] = this->_values.size();
+    this->_args.assign(this->_argoff.back(), CFG::NONE);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* walks the dominator tree with a stack of live names per variable. the walk
+ * keeps its own stack, so nesting depth costs heap, not call frames. */
+void
+SSAForm::rename(void)
+{
+    const CFG &g = this->_g;
+    vector<vector<unsigned> > names(this->_nvars);
+    /* node, leaving */
+    vector<pair<unsigned, bool> > stack;
+
+    for (varid v = 0; v < this->_nvars; ++v) names[v].push_back(v);
+    stack.push_back(make_pair(g.entry(), false));
+    while (!stack.empty()) {
+        const unsigned n = stack.back().first;
+        const bool leaving = stack.back().second;
+        const unsigned dv = this->_defval[n];
+        stack.pop_back();
+        if (leaving) {
+            if (CFG::NONE != dv) names[this->_values[dv].var].pop_back();
+            for (unsigned p = this->_phioff[n]; p < this->_phioff[n + 1]; ++p) {
+                names[this->_values[p].var].pop_back();
+            }
+            continue;
+        }
+        for (unsigned p = this->_phioff[n]; p < this->_phioff[n + 1]; ++p) {
+            names[this->_values[p].var].push_back(p);
+        }
+        for (unsigned u = this->_useoff[n]; u < this->_useoff[n + 1]; ++u) {
+            this->_useval[u] = names[this->_usevar[u]].back();
+        }
+        if (CFG::NONE != dv) names[this->_values[dv].var].push_back(dv);
+        /* fill the operands successors' phis take from this node */
+        for (unsigned s = 0; s < g.nsuccs(n); ++s) {
+            unsigned m = g.succs(n)[s];
+            for (unsigned j = 0; j < g.npreds(m); ++j) {
+                if (g.preds(m)[j] != n) continue;
+                for (unsigned p = this->_phioff[m];
+                     p < this->_phioff[m + 1]; ++p) {
+                    this->_args[this->_argoff[p - this->_phi0] + j] =
+                        names[this->_values[p].var].back();
+                }
+            }
+        }
+        stack.push_back(make_pair(n, true));
+        for (unsigned k = this->_doff[n]; k < this->_doff[n + 1]; ++k) {
+            stack.push_back(make_pair(this->_dkids[k], false));
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* packs value -> reads and value -> phis the same way CFG packs edges */
+static void
+pack(size_t nvalues,
+     const vector<pair<unsigned, unsigned> > &links,
+     vector<unsigned> &off,
+     vector<unsigned> &to)
+{
+    off.assign(nvalues + 1, 0);
+    for (const auto &l : links) ++off[l.first + 1];
+    for (size_t v = 0; v < nvalues; ++v) off[v + 1] += off[v];
+    to.resize(links.size());
+    vector<unsigned> fill(off.begin(), off.end() - 1);
+    for (const auto &l : links) to[fill[l.first]++] = l.second;
+}
+
+void
+SSAForm::chains(void)
+{
+    vector<pair<unsigned, unsigned> > links;
+
+    for (unsigned u = 0; u < this->_useval.size(); ++u) {
+        if (CFG::NONE == this->_useval[u]) continue;
+        links.push_back(make_pair(this->_useval[u], u));
+    }
+    pack(this->_values.size(), links, this->_duoff, this->_du);
+    links.clear();
+    for (unsigned p = this->_phi0; p < this->_values.size(); ++p) {
+        const unsigned *a = this->args(p);
+        for (unsigned j = 0; j < this->nargs(p); ++j) {
+            if (CFG::NONE != a[j]) links.push_back(make_pair(a[j], p));
+        }
+    }
+    pack(this->_values.size(), links, this->_puoff, this->_pu);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* a phi stands for the union of what its operands stand for. only phis are
+ * ever revisited, and only when an operand phi grew. */
+void
+SSAForm::solve(void)
+{
+    const unsigned nphis = this->nphis();
+    vector<bool> queued(nphis, true);
+    vector<unsigned> work;
+    vector<size_t> acc, tmp;
+
+    for (unsigned i = nphis; i > 0; --i) work.push_back(this->_phi0 + i - 1);
+    while (!work.empty()) {
+        unsigned p = work.back();
+        work.pop_back();
+        queued[p - this->_phi0] = false;
+        ++this->_visits;
+        acc.clear();
+        const unsigned *a = this->args(p);
+        for (unsigned j = 0; j < this->nargs(p); ++j) {
+            if (CFG::NONE == a[j]) continue;
+            const vector<size_t> &r = this->_reach[a[j]];
+            tmp.clear();
+            set_union(acc.begin(), acc.end(), r.begin(), r.end(),
+                      back_inserter(tmp));
+            acc.swap(tmp);
+        }
+        if (acc == this->_reach[p]) continue;
+        this->_reach[p] = acc;
+        for (unsigned k = this->_puoff[p]; k < this->_puoff[p + 1]; ++k) {
+            unsigned q = this->_pu[k];
+            if (!queued[q - this->_phi0]) {
+                queued[q - this->_phi0] = true;
+                work.push_back(q);
+            }
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+SSAForm::addReach(BitVector &b, unsigned v) const
+{
+    for (size_t d : this->_reach[v]) b.set(d);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* the dense set at a node is the union of what the live name of every
+ * variable stands for. the same dominator tree walk as rename keeps one
+ * running set and patches a single variable's bits whenever its name
+ * changes. */
+void
+SSAForm::publish(void) const
+{
+    const CFG &g = this->_g;
+    vector<vector<unsigned> > names(this->_nvars);
+    vector<pair<unsigned, bool> > stack;
+    BitVector cur(this->_defs.size()), in;
+
+    auto bind = [&](unsigned v) {
+        varid x = this->_values[v].var;
+        cur.andNot(this->_defs.kill(this->_values[x].def));
+        names[x].push_back(v);
+        this->addReach(cur, v);
+    };
+    auto unbind = [&](unsigned v) {
+        varid x = this->_values[v].var;
+        cur.andNot(this->_defs.kill(this->_values[x].def));
+        names[x].pop_back();
+        this->addReach(cur, names[x].back());
+    };
+
+    for (varid v = 0; v < this->_nvars; ++v) {
+        names[v].push_back(v);
+        this->addReach(cur, v);
+    }
+    stack.push_back(make_pair(g.entry(), false));
+    while (!stack.empty()) {
+        const unsigned n = stack.back().first;
+        const bool leaving = stack.back().second;
+        const unsigned dv = this->_defval[n];
+        stack.pop_back();
+        if (leaving) {
+            if (CFG::NONE != dv) unbind(dv);
+            for (unsigned p = this->_phioff[n + 1]; p > this->_phioff[n]; ) {
+                unbind(--p);
+            }
+            continue;
+        }
+        for (unsigned p = this->_phioff[n]; p < this->_phioff[n + 1]; ++p) {
+            bind(p);
+        }
+        in = cur;
+        if (CFG::NONE != dv) bind(dv);
+        const CFGNode &node = g.node(n);
+        switch (node.kind) {
+            case CFG_STMT:
+            case CFG_TEST:
+                node.stmt->rdbits(in, cur);
+                break;
+            case CFG_MERGE:
+                node.owner->rdbits(in, cur);
+                break;
+            default:
+                break;
+        }
+        stack.push_back(make_pair(n, true));
+        for (unsigned k = this->_doff[n]; k < this->_doff[n + 1]; ++k) {
+            stack.push_back(make_pair(this->_dkids[k], false));
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ssaemit(Sink &out,
+        const SymbolTable &syms,
+        const CFG &g,
+        const DefTable &defs,
+        const SSAForm &ssa)
+{
+    /* definition -> labels of the statements reading it, through phis */
+    vector<vector<int> > readers(defs.size());
+    for (unsigned n = 0; n < g.size(); ++n) {
+        for (unsigned u = ssa.firstUse(n); u < ssa.firstUse(n + 1); ++u) {
+            if (CFG::NONE == ssa.useValue(u)) continue;
+            for (size_t d : ssa.reach(ssa.useValue(u))) {
+                readers[d].push_back(g.node(n).label);
+            }
+        }
+    }
+    for (auto &r : readers) {
+        sort(r.begin(), r.end());
+        r.erase(unique(r.begin(), r.end()), r.end());
+    }
+
+    vector<unsigned> byname;
+    for (unsigned n = 0; n < g.size(); ++n) {
+        const CFGNode &node = g.node(n);
+        if (CFG_STMT != node.kind && CFG_TEST != node.kind) continue;
+        out << '[' << g.text(n) << "] -- " << node.label << '\n';
+        byname.clear();
+        for (unsigned u = ssa.firstUse(n); u < ssa.firstUse(n + 1); ++u) {
+            byname.push_back(u);
+        }
+        sort(byname.begin(), byname.end(), [&](unsigned a, unsigned b) {
+            return syms.rank(ssa.useVar(a)) < syms.rank(ssa.useVar(b));
+        });
+        for (unsigned u : byname) {
+            vlabmap m;
+            if (CFG::NONE != ssa.useValue(u)) {
+                for (size_t d : ssa.reach(ssa.useValue(u))) {
+                    m.insert(make_pair(defs.def(d).var, defs.def(d).label));
+                }
+            }
+            out << "  " << syms.name(ssa.useVar(u)) << " <- ";
+            Node::emitVLabSet(out, syms, m);
+        }
+        size_t d = CFG_STMT == node.kind ? defs.defAt(node.label)
+                                         : DefTable::NONE;
+        if (DefTable::NONE == d) continue;
+        out << "  " << syms.name(defs.def(d).var) << " -> {";
+        for (int l : readers[d]) out << ' ' << l;
+        out << " }\n";
+    }
+}
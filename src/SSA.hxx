@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SSA_H_INCLUDED
+#define SSA_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "CFG.hxx"
+#include "ReachingDefs.hxx"
+#include "Sink.hxx"
+#include "SymbolTable.hxx"
+
+#include <vector>
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* one ssa name. entry values stand for "undefined on entry", the others for
+ * an assignment or a phi. */
+struct SSAValue {
+    varid var;
+    /* defining node: the entry, an assignment, or the join a phi sits on */
+    unsigned node;
+    /* DefTable index of entry values and assignments, NONE for phis */
+    size_t def;
+
+    SSAValue(varid v, unsigned n, size_t d) : var(v), node(n), def(d) { ; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* static single assignment form over a control flow graph. phis are placed on
+ * the iterated dominance frontiers of each variable's definitions, which are
+ * the if merges and while tests buildCFG makes. every read is bound to the
+ * one name that reaches it, and reaching definitions are solved over phis
+ * only, so work and memory follow the number of definitions and uses instead
+ * of nodes times variables. */
+class SSAForm {
+private:
+    const CFG &_g;
+    const DefTable &_defs;
+    /* immediate dominators. the entry is its own. */
+    std::vector<unsigned> _idom;
+    /* dominator tree children */
+    std::vector<unsigned> _doff, _dkids;
+    /* entry values first, one per variable, then assignments, then phis */
+    std::vector<SSAValue> _values;
+    size_t _nvars;
+    unsigned _phi0;
+    /* the phis of node n are values _phioff[n] ... _phioff[n + 1] - 1 */
+    std::vector<unsigned> _phioff;
+    /* operands of phi p, one per predecessor of its node, in predecessor
+     * order, start at _args[_argoff[p - _phi0]] */
+    std::vector<unsigned> _argoff, _args;
+    /* the value an assignment node defines, NONE elsewhere */
+    std::vector<unsigned> _defval;
+    /* reads of node n are _usevar[_useoff[n]] ..., bound to _useval[...] */
+    std::vector<unsigned> _useoff;
+    std::vector<varid> _usevar;
+    std::vector<unsigned> _useval;
+    /* def-use chains: the reads of value v, and the phis reading it */
+    std::vector<unsigned> _duoff, _du;
+    std::vector<unsigned> _puoff, _pu;
+    /* per value: the definitions it stands for, in DefTable order */
+    std::vector<std::vector<size_t> > _reach;
+    unsigned long _visits;
+
+    SSAForm(void);
+    SSAForm(const SSAForm &);
+    SSAForm &operator=(const SSAForm &);
+
+    void dominators(void);
+
+    void placePhis(void);
+
+    void rename(void);
+
+    void chains(void);
+
+    void addReach(BitVector &b, unsigned v) const;
+
+public:
+    SSAForm(const CFG &g, const DefTable &defs);
+
+    ~SSAForm(void) { ; }
+    /* reaching definitions of every phi */
+    void solve(void);
+
+    unsigned long visits(void) const { return this->_visits; }
+
+    unsigned idom(unsigned n) const { return this->_idom[n]; }
+
+    unsigned nvalues(void) const { return this->_values.size(); }
+
+    const SSAValue &value(unsigned v) const { return this->_values[v]; }
+
+    unsigned nphis(void) const { return this->_values.size() - this->_phi0; }
+
+    bool phi(unsigned v) const { return v >= this->_phi0; }
+
+    unsigned nargs(unsigned p) const {
+        return this->_g.npreds(this->_values[p].node);
+    }
+
+    const unsigned *args(unsigned p) const {
+        return this->_args.data() + this->_argoff[p - this->_phi0];
+    }
+
+    unsigned nuses(void) const { return this->_usevar.size(); }
+    /* reads at node n are uses firstUse(n) ... firstUse(n + 1) - 1 */
+    unsigned firstUse(unsigned n) const { return this->_useoff[n]; }
+
+    varid useVar(unsigned u) const { return this->_usevar[u]; }
+
+    unsigned useValue(unsigned u) const { return this->_useval[u]; }
+    /* reads bound directly to value v */
+    unsigned ndu(unsigned v) const {
+        return this->_duoff[v + 1] - this->_duoff[v];
+    }
+
+    const unsigned *du(unsigned v) const {
+        return this->_du.data() + this->_duoff[v];
+    }
+    /* definitions value v stands for. valid after solve. */
+    const std::vector<size_t> &reach(unsigned v) const {
+        return this->_reach[v];
+    }
+    /* rebuilds the dense entry and exit sets of every node from the sparse
+     * result and hands them to the statements, like RDWorklist::publish */
+    void publish(void) const;
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* prints, for every statement and test, the definitions reaching each of its
+ * reads and the statements reading the definition it makes */
+void ssaemit(Sink &out,
+             const SymbolTable &syms,
+             const CFG &g,
+             const DefTable &defs,
+             const SSAForm &ssa);
+
+#endif
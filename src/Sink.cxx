@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Sink.hxx"
+
+using namespace std;
+
+const size_t Sink::BUFSZ = 64 * 1024;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+Sink::Sink(ostream &os) : _os(os)
+{
+    ;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Sink::flush(void)
+{
+    if (this->_buf.empty()) return;
+    this->_os.write(this->_buf.data(), this->_buf.size());
+    this->_buf.clear();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+Sink &
+Sink::operator<<(int i)
+{
+    char digits[16];
+    char *p = digits + sizeof(digits);
+    /* negate in unsigned so INT_MIN works */
+    unsigned u = i < 0 ? 0U - unsigned(i) : unsigned(i);
+
+    do {
+        *--p = char('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (i < 0) *--p = '-';
+    this->_buf.append(p, digits + sizeof(digits) - p);
+    this->spill();
+    return *this;
+}
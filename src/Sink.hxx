@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SINK_H_INCLUDED
+#define SINK_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <iostream>
+#include <string>
+
+/* buffered text output for reports. text collects in one large buffer that
+ * is handed to the stream only when it fills, on flush and on destruction,
+ * so printing never flushes per line and never goes through the stream one
+ * item at a time. */
+class Sink {
+private:
+    std::ostream &_os;
+    /* pending output, written out whenever it grows past BUFSZ */
+    std::string _buf;
+
+    static const size_t BUFSZ;
+
+    Sink(void);
+    Sink(const Sink &);
+    Sink &operator=(const Sink &);
+
+    void spill(void) {
+        if (this->_buf.size() >= Sink::BUFSZ) this->flush();
+    }
+
+public:
+    explicit Sink(std::ostream &os);
+
+    ~Sink(void) { this->flush(); }
+    /* hands pending output to the stream. the stream itself is not flushed. */
+    void flush(void);
+
+    Sink &operator<<(const char *s) {
+        this->_buf += s;
+        this->spill();
+        return *this;
+    }
+
+    Sink &operator<<(const std::string &s) {
+        this->_buf += s;
+        this->spill();
+        return *this;
+    }
+
+    Sink &operator<<(char c) {
+        this->_buf += c;
+        this->spill();
+        return *this;
+    }
+
+    Sink &operator<<(int i);
+    /* two spaces per nesting level, like Base::pad */
+    Sink &pad(unsigned depth) {
+        this->_buf.append(2 * size_t(depth), ' ');
+        this->spill();
+        return *this;
+    }
+};
+
+#endif
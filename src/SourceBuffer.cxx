@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SourceBuffer.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static string
+why(const string &what, const string &path, int err)
+{
+    return what + ": " + path + ". why: " + strerror(err) + ".";
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+SourceBuffer::SourceBuffer(const string &path) :
+    _base(NULL), _size(0), _mapped(0)
+{
+    int fd = -1;
+    struct stat sb;
+
+    if (-1 == (fd = open(path.c_str(), O_RDONLY))) {
+        throw DFlowException(DFLOW_WHERE, why("cannot open", path, errno));
+    }
+    if (-1 == fstat(fd, &sb) || !S_ISREG(sb.st_mode)) {
+        this->slurp(fd, path);
+        close(fd);
+        return;
+    }
+    this->_size = sb.st_size;
+    this->_mapped = this->_size + 2;
+    /* reserve zeroed memory for the file plus its terminator, then map the
+     * file over the front of it. whatever the file does not cover, including
+     * the terminator, stays zero. */
+    void *base = mmap(NULL, this->_mapped, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == base) {
+        int err = errno;
+        close(fd);
+        throw DFlowException(DFLOW_WHERE, why("cannot map", path, err));
+    }
+    if (0 != this->_size &&
+        MAP_FAILED == mmap(base, this->_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_FIXED, fd, 0)) {
+        int err = errno;
+        munmap(base, this->_mapped);
+        close(fd);
+        throw DFlowException(DFLOW_WHERE, why("cannot map", path, err));
+    }
+    /* the mapping holds its own reference to the file */
+    close(fd);
+    this->_base = static_cast<char *>(base);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+SourceBuffer::~SourceBuffer(void)
+{
+    if (0 != this->_mapped) munmap(this->_base, this->_mapped);
+    else free(this->_base);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+SourceBuffer::slurp(int fd, const string &path)
+{
+    size_t cap = 64 * 1024;
+    ssize_t n = 0;
+
+    if (NULL == (this->_base = static_cast<char *>(malloc(cap)))) {
+        close(fd);
+        throw bad_alloc();
+    }
+    while (0 != (n = read(fd, this->_base + this->_size,
+                          cap - this->_size - 2))) {
+        if (-1 == n) {
+            int err = errno;
+            if (EINTR == err) continue;
+            free(this->_base);
+            close(fd);
+            throw DFlowException(DFLOW_WHERE, why("cannot read", path, err));
+        }
+        this->_size += n;
+        if (cap - this->_size < 2 + 4096) {
+            char *grown = static_cast<char *>(realloc(this->_base, cap *= 2));
+            if (NULL == grown) {
+                free(this->_base);
+                close(fd);
+                throw bad_alloc();
+            }
+            this->_base = grown;
+        }
+    }
+    this->_base[this->_size] = this->_base[this->_size + 1] = '\0';
+}
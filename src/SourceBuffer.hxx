@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOURCE_BUFFER_H_INCLUDED
+#define SOURCE_BUFFER_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string>
+#include <cstddef>
+
+/* an input file mapped into memory, followed by the two zero bytes the
+ * scanner wants at the end of its buffer. the mapping is private, so the
+ * scanner may write to it without touching the file. inputs that cannot be
+ * mapped (pipes, say) are read instead. */
+class SourceBuffer {
+private:
+    char *_base;
+    /* file size */
+    size_t _size;
+    /* bytes mapped, or 0 if _base came from malloc */
+    size_t _mapped;
+
+    SourceBuffer(void);
+    SourceBuffer(const SourceBuffer &);
+    SourceBuffer &operator=(const SourceBuffer &);
+
+    void slurp(int fd, const std::string &path);
+
+public:
+    SourceBuffer(const std::string &path);
+
+    ~SourceBuffer(void);
+
+    char *data(void) { return this->_base; }
+
+    size_t size(void) const { return this->_size; }
+};
+
+#endif
@@ -18,10 +18,15 @@
 %defines "SourceParser.hh"
 
 %error-verbose
+%define api.pure full
+%param { ParseContext *ctx }
 /*声明定义段*/
 %{
 
+#include "Base.hxx"
 #include "Program.hxx"
+#include "ParseContext.hxx"
+#include "SymbolTable.hxx"
 
 #include <cstdlib>
 #include <iostream>
@@ -29,20 +34,16 @@
 #include <cstdlib>
 #include <vector>
 
-int yylex(void);
-extern "C" int yyerror(const char *s);
-extern "C" FILE *yyin;
-
-/* pointer to the top-level program block */
-Block *programRoot = NULL;
-
-/* input line number used for nice error messages */
-extern int lineNo;
+/* every open if and while holds a few entries of the parse stack, which
+ * bison grows on the heap up to this many. its default of 10000 stops
+ * programs a couple of thousand levels deep. */
+#define YYMAXDEPTH 10000000
 
 %}
 
 %union {
-    std::string *str;
+    Token tok;
+    BinOp op;
     Block *block;
     Identifier *ident;
     Expression *expression;
@@ -50,45 +51,53 @@ extern int lineNo;
     Statements *statements;
 }
 
-%token <str> ID INT FLOAT SEND
-             OPPLUS OPMIN OPMUL OPDIV
-             ASSIGN EQ LT LTE GT GTE
-             OR AND NOT TRUE FALSE;
+%token <tok> ID INT FLOAT;
+
+%token SEND OPPLUS OPMIN OPMUL OPDIV
+       ASSIGN EQ LT LTE GT GTE
+       OR AND NOT TRUE FALSE;
 
 %token IF THEN ELSE FI SKIP WHILE DO OD;
 
 %type <block> program statements;
 %type <expression> aexpr bexpr assignexpr expr num logical;
 %type <statement> skipstat statement;
-%type <str> mathbinop logicbinop;
+%type <op> mathbinop logicbinop;
 %type <ident> ident;
 
+%code {
+/* defined by the scanner. hands out tokens from whichever scanner ctx uses. */
+int yylex(YYSTYPE *lvalp, ParseContext *ctx);
+
+static void yyerror(ParseContext *ctx, const char *s);
+}
+
 %start program
 
 %%
 
-program : statements { programRoot = $1; }
+program : statements { ctx->root = $1; $1->defsites(ctx->defsites); }
         ;
 
-statements : statement { $$ = new Block(); $$->add($1); }
+statements : statement { $$ = ctx->make<Block>(); $$->add($1); }
            | statements statement { $1->add($2); }
            ;
 
-statement  : assignexpr SEND { $$ = new Statement($1); }
+statement  : assignexpr SEND { $$ = ctx->make<Statement>($1); }
            | skipstat { $$ = $1; }
            | IF expr THEN statements ELSE statements FI {
-                 Block *exprBlock = new Block();
-                 Statement *exprStatement = new Statement($2);
+                 Block *exprBlock = ctx->make<Block>();
+                 Statement *exprStatement = ctx->make<Statement>($2);
                  exprStatement->exprStatement(true);
                  exprBlock->add(exprStatement);
-                 $$ = new IfStatement(exprBlock, $4, $6);
+                 $$ = ctx->make<IfStatement>(exprBlock, $4, $6);
              }
            | WHILE expr DO statements OD {
-                 Block *exprBlock = new Block();
-                 Statement *exprStatement = new Statement($2);
+                 Block *exprBlock = ctx->make<Block>();
+                 Statement *exprStatement = ctx->make<Statement>($2);
                  exprStatement->exprStatement(true);
                  exprBlock->add(exprStatement);
-                 $$ = new WhileStatement(exprBlock, $4);
+                 $$ = ctx->make<WhileStatement>(exprBlock, $4);
              }
            ;
 
@@ -98,68 +107,92 @@ expr : aexpr { $$ = $1; }
      | NOT expr { $2->notit(); $$ = $2; }
      ;
 
-skipstat : SKIP SEND { $$ = new Skip(); }
+skipstat : SKIP SEND { $$ = ctx->make<Skip>(); }
          ;
 
-assignexpr : ident ASSIGN expr { $$ = new AssignmentExpression($1, $3); }
+assignexpr : ident ASSIGN expr {
+                 AssignmentExpression *a =
+                     ctx->make<AssignmentExpression>($1, $3);
+                 ctx->defsites.push_back(a);
+                 $$ = a;
+             }
            ;
 
-bexpr : logical logicbinop logical { $$ = new LogicalExpression($1, $2, $3); }
-      | logical logicbinop ident { $$ = new LogicalExpression($1, $2, $3); }
-      | ident logicbinop ident { $$ = new LogicalExpression($1, $2, $3); }
-      | ident logicbinop logical { $$ = new LogicalExpression($1, $2, $3); }
-      | ident logicbinop num { $$ = new LogicalExpression($1, $2, $3); }
-      | num logicbinop ident { $$ = new LogicalExpression($1, $2, $3); }
-      | num logicbinop num { $$ = new LogicalExpression($1, $2, $3); }
+bexpr : logical logicbinop logical {
+          $$ = ctx->make<LogicalExpression>($1, $2, $3);
+      }
+      | logical logicbinop ident {
+          $$ = ctx->make<LogicalExpression>($1, $2, $3);
+      }
+      | ident logicbinop ident {
+          $$ = ctx->make<LogicalExpression>($1, $2, $3);
+      }
+      | ident logicbinop logical {
+          $$ = ctx->make<LogicalExpression>($1, $2, $3);
+      }
+      | ident logicbinop num {
+          $$ = ctx->make<LogicalExpression>($1, $2, $3);
+      }
+      | num logicbinop ident {
+          $$ = ctx->make<LogicalExpression>($1, $2, $3);
+      }
+      | num logicbinop num {
+          $$ = ctx->make<LogicalExpression>($1, $2, $3);
+      }
       | logical { $$ = $1; }
       ;
 
-aexpr : num mathbinop num { $$ = new ArithmeticExpression($1, $2, $3); }
-      | num mathbinop ident { $$ = new ArithmeticExpression($1, $2, $3); }
-      | ident mathbinop ident { $$ = new ArithmeticExpression($1, $2, $3); }
-      | ident mathbinop num { $$ = new ArithmeticExpression($1, $2, $3); }
+aexpr : num mathbinop num {
+          $$ = ctx->make<ArithmeticExpression>($1, $2, $3);
+      }
+      | num mathbinop ident {
+          $$ = ctx->make<ArithmeticExpression>($1, $2, $3);
+      }
+      | ident mathbinop ident {
+          $$ = ctx->make<ArithmeticExpression>($1, $2, $3);
+      }
+      | ident mathbinop num {
+          $$ = ctx->make<ArithmeticExpression>($1, $2, $3);
+      }
       | num { $$ = $1;  }
       ;
 
-ident : ID { $$ = new Identifier(*$1); delete $1; }
+ident : ID {
+          varid v = ctx->syms->intern($1.text, $1.len);
+          $$ = ctx->make<Identifier>(v, &ctx->syms->name(v));
+      }
       ;
 
-num : INT { $$ = new Int(*$1); delete $1; }
-    | FLOAT { $$ = new Float(*$1); delete $1; }
+num : INT { $$ = ctx->make<Int>(Base::string2int($1.text, $1.len)); }
+    | FLOAT { $$ = ctx->make<Float>(Base::string2float($1.text, $1.len)); }
     ;
 
-logical : TRUE { $$ = new Logical(*$1); delete $1; }
-        | FALSE { $$ = new Logical(*$1); delete $1; }
+logical : TRUE { $$ = ctx->make<Logical>(true); }
+        | FALSE { $$ = ctx->make<Logical>(false); }
         ;
 
-mathbinop : OPPLUS | OPMIN | OPMUL | OPDIV
+mathbinop : OPPLUS { $$ = OP_ADD; }
+          | OPMIN { $$ = OP_SUB; }
+          | OPMUL { $$ = OP_MUL; }
+          | OPDIV { $$ = OP_DIV; }
           ;
 
-logicbinop : EQ | LT | LTE | GT | GTE | OR | AND
+logicbinop : EQ { $$ = OP_EQ; }
+           | LT { $$ = OP_LT; }
+           | LTE { $$ = OP_LTE; }
+           | GT { $$ = OP_GT; }
+           | GTE { $$ = OP_GTE; }
+           | OR { $$ = OP_OR; }
+           | AND { $$ = OP_AND; }
            ;
 
 %%
 /*定义辅助函数*/
 /* ////////////////////////////////////////////////////////////////////////// */
-/* wrapper for yyparse */
-int
-parserParse(FILE *fp = NULL)
-{
-    /* set YYDEBUG to anything for more parser debug output */
-    yydebug = !!getenv("YYDEBUG");
-    /* set yyin */
-    yyin = fp;
-    /* fp closed by caller */
-    return yyparse();
-}
-
-/* ////////////////////////////////////////////////////////////////////////// */
-int
-yyerror(const char *s)
+static void
+yyerror(ParseContext *ctx, const char *s)
 {
-    std::cout << "parse error:" << std::endl
+    *ctx->out << "parse error:" << std::endl
               << "- what: " << s << std::endl
-              << "- around: line " << lineNo << std::endl;
-    /* ignored */
-    return 42;
+              << "- around: line " << ctx->lineNo << std::endl;
 }
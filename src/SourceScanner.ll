@@ -17,7 +17,8 @@
 
 /* source code scanner for our target language */
 
-%option interactive noyywrap nounput noinput
+%option reentrant bison-bridge noyywrap nounput noinput
+%option extra-type="ParseContext *"
 
 /* uncomment for tons of flex output */
 /* %option debug */
@@ -30,21 +31,27 @@
 #include <string>
 
 #include "Program.hxx"
+#include "FastScanner.hxx"
+#include "ParseContext.hxx"
 #include "SourceParser.hh"
-// yylval.str
+// yylval->tok
 // yytext 当前识别的词法单元（词文）的指针
 // yyleng 当前识别的词法单元（词文）的长度
+/* tokens are views into the input buffer. the parser is done with them
+ * before the buffer goes away. */
 #define SAVE_STOKEN                                                            \
 do {                                                                           \
-    yylval.str = new std::string(yytext, yyleng);                              \
+    yylval->tok.text = yytext;                                                 \
+    yylval->tok.len = yyleng;                                                  \
 } while (0)
 
-int lineNo = 1;
+/* yylex is ours. it picks the scanner. */
+#define YY_DECL int flexScan(YYSTYPE *yylval_param, yyscan_t yyscanner)
 
 %}
 /*词法规则段*/
 %%
-[\n] { ++lineNo; }
+[\n] { ++yyextra->lineNo; }
 
 [ \t] { ; }
 
@@ -56,9 +63,9 @@ int lineNo = 1;
 
 "fi" { return FI; }
 
-"true" { SAVE_STOKEN; return TRUE; }
+"true" { return TRUE; }
 
-"false" { SAVE_STOKEN; return FALSE; }
+"false" { return FALSE; }
 
 "skip" { return SKIP; }
 
@@ -74,37 +81,37 @@ int lineNo = 1;
 
 [a-zA-Z][a-zA-Z]* { SAVE_STOKEN; return ID; }
 
-"+" { SAVE_STOKEN; return OPPLUS; }
+"+" { return OPPLUS; }
 
-"-" { SAVE_STOKEN; return OPMIN; }
+"-" { return OPMIN; }
 
-"*" { SAVE_STOKEN; return OPMUL; }
+"*" { return OPMUL; }
 
-"/" { SAVE_STOKEN; return OPDIV; }
+"/" { return OPDIV; }
 
-"=" { SAVE_STOKEN; return ASSIGN; }
+"=" { return ASSIGN; }
 
-"==" { SAVE_STOKEN; return EQ; }
+"==" { return EQ; }
 
-"<" { SAVE_STOKEN; return LT; }
+"<" { return LT; }
 
-"<=" { SAVE_STOKEN; return LTE; }
+"<=" { return LTE; }
 
-">" { SAVE_STOKEN; return GT; }
+">" { return GT; }
 
-">=" { SAVE_STOKEN; return GTE; }
+">=" { return GTE; }
 
-"||" { SAVE_STOKEN; return OR; }
+"||" { return OR; }
 
-"&&" { SAVE_STOKEN; return AND; }
+"&&" { return AND; }
 
-"!" { SAVE_STOKEN; return NOT; }
+"!" { return NOT; }
 
 ";" { return SEND; }
 
-. { std::cerr << "invalid token encountered during source scan: "
-              << "\'" << std::string(yytext, yyleng) << "\'"
-              << std::endl;
+. { *yyextra->err << "invalid token encountered during source scan: "
+                   << "\'" << std::string(yytext, yyleng) << "\'"
+                   << std::endl;
     yyterminate();
   }
 
@@ -113,4 +120,41 @@ int lineNo = 1;
 // .匹配任意字符，除了 \n。
 /*
 yyterminate()  终止扫描
-*/
\ No newline at end of file
+*/
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+yylex(YYSTYPE *lvalp, ParseContext *ctx)
+{
+    if (NULL != ctx->fast) return ctx->fast->next(lvalp->tok, ctx->lineNo);
+    return flexScan(lvalp, ctx->flex);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+parserParse(char *buf, size_t len, ParseContext &ctx)
+{
+    yyscan_t scanner;
+    int rc = 0;
+
+    /* set YYDEBUG to anything for more parser debug output */
+    if (getenv("YYDEBUG")) yydebug = 1;
+    if (SCAN_FAST == ctx.scan) {
+        FastScanner fast(buf, len, *ctx.err);
+        ctx.fast = &fast;
+        rc = yyparse(&ctx);
+        ctx.fast = NULL;
+        return rc;
+    }
+    if (0 != yylex_init_extra(&ctx, &scanner)) return 1;
+    /* scans buf in place. fails unless buf ends with two zeros. */
+    if (NULL == yy_scan_buffer(buf, len + 2, scanner)) {
+        yylex_destroy(scanner);
+        return 1;
+    }
+    ctx.flex = scanner;
+    rc = yyparse(&ctx);
+    ctx.flex = NULL;
+    yylex_destroy(scanner);
+    return rc;
+}
@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Stats.hxx"
+#include "Base.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+#include "Options.hxx"
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+using namespace std;
+
+bool Stats::_on = false;
+Stats::Clock::time_point Stats::_epoch;
+atomic<uint64_t> Stats::_counters[STAT_N];
+atomic<uint64_t> Stats::_loops[Stats::LOOP_BUCKETS];
+mutex Stats::_lock;
+vector<Stats::Event> Stats::_events;
+
+static const char *counterNames[STAT_N] = {
+    "rd visits: node",
+    "rd visits: assignment",
+    "rd visits: statement",
+    "rd visits: block",
+    "rd visits: skip",
+    "rd visits: if",
+    "rd visits: while",
+    "rd set copies",
+    "rd set compares",
+    "arena objects",
+    "arena bytes",
+    "arena chunks",
+    "forks spawned",
+    "forks inlined"
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* small dense thread numbers for the trace viewer */
+unsigned
+Stats::tid(void)
+{
+    static atomic<unsigned> next(0);
+    static thread_local unsigned id = next++;
+    return id;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Stats::enable(void)
+{
+    for (auto &c : Stats::_counters) c = 0;
+    for (auto &l : Stats::_loops) l = 0;
+    Stats::_events.clear();
+    Stats::_epoch = Clock::now();
+    Stats::_on = true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Stats::loop(unsigned long iters)
+{
+    if (!Stats::_on) return;
+    unsigned b = 0;
+    while (iters > 1 && b + 1 < Stats::LOOP_BUCKETS) {
+        iters >>= 1;
+        ++b;
+    }
+    Stats::_loops[b].fetch_add(1, memory_order_relaxed);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Stats::phase(const char *name, const string &arg, Clock::time_point start)
+{
+    Clock::time_point end = Clock::now();
+    Event e;
+
+    e.name = name;
+    e.arg = arg;
+    e.ts = chrono::duration<double, micro>(start - Stats::_epoch).count();
+    e.dur = chrono::duration<double, micro>(end - start).count();
+    e.tid = Stats::tid();
+    lock_guard<mutex> g(Stats::_lock);
+    Stats::_events.push_back(e);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Stats::summary(ostream &os)
+{
+    struct Total {
+        unsigned long n;
+        double sum, max;
+    };
+    /* first-seen order keeps phases in pipeline order */
+    vector<string> order;
+    map<string, Total> totals;
+
+    {
+        lock_guard<mutex> g(Stats::_lock);
+        for (const Event &e : Stats::_events) {
+            auto it = totals.find(e.name);
+            if (totals.end() == it) {
+                Total t = {0, 0.0, 0.0};
+                it = totals.insert(make_pair(e.name, t)).first;
+                order.push_back(e.name);
+            }
+            ++it->second.n;
+            it->second.sum += e.dur;
+            if (e.dur > it->second.max) it->second.max = e.dur;
+        }
+    }
+    os << "> stats: phases" << endl;
+    os << "  " << left << setw(24) << "phase" << right << setw(8) << "calls"
+       << setw(14) << "total ms" << setw(14) << "max ms" << endl;
+    os << fixed << setprecision(3);
+    for (const string &n : order) {
+        const Total &t = totals[n];
+        os << "  " << left << setw(24) << n << right << setw(8) << t.n
+           << setw(14) << t.sum / 1000.0 << setw(14) << t.max / 1000.0
+           << endl;
+    }
+    os.unsetf(ios::floatfield);
+    os << "> stats: counters" << endl;
+    for (int c = 0; c < STAT_N; ++c) {
+        os << "  " << left << setw(24) << counterNames[c] << right
+           << setw(16) << Stats::_counters[c].load() << endl;
+    }
+    os << "> stats: while loop iterations" << endl;
+    for (unsigned b = 0; b < Stats::LOOP_BUCKETS; ++b) {
+        uint64_t n = Stats::_loops[b].load();
+        if (0 == n) continue;
+        unsigned long lo = 1UL << b, hi = (2UL << b) - 1;
+        string range = Base::int2string(lo);
+        if (hi != lo) range += "-" + Base::int2string(hi);
+        if (b + 1 == Stats::LOOP_BUCKETS) range += "+";
+        os << "  " << left << setw(24) << range << right << setw(16) << n
+           << endl;
+    }
+    os << left;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Stats::trace(const string &path)
+{
+    ofstream os(path.c_str());
+    bool first = true;
+
+    if (!os) throw DFlowException(DFLOW_WHERE, "cannot open: " + path);
+    os << fixed << setprecision(3);
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl;
+    lock_guard<mutex> g(Stats::_lock);
+    for (const Event &e : Stats::_events) {
+        os << (first ? "" : ",\n") << "{\"name\":"
+           << Options::quote(e.name)
+           << ",\"cat\":\"dflow\",\"ph\":\"X\",\"ts\":" << e.ts
+           << ",\"dur\":" << e.dur << ",\"pid\":1,\"tid\":" << e.tid;
+        if (!e.arg.empty()) {
+            os << ",\"args\":{\"input\":" << Options::quote(e.arg) << "}";
+        }
+        os << "}";
+        first = false;
+    }
+    os << endl << "]}" << endl;
+    if (!os) throw DFlowException(DFLOW_WHERE, "cannot write: " + path);
+}
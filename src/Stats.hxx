@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATS_H_INCLUDED
+#define STATS_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+
+#include <stdint.h>
+
+/* what --stats counts */
+enum StatCounter {
+    /* rdgo and rdgobv calls, by node kind */
+    STAT_VISIT_NODE = 0,
+    STAT_VISIT_ASSIGN,
+    STAT_VISIT_STATEMENT,
+    STAT_VISIT_BLOCK,
+    STAT_VISIT_SKIP,
+    STAT_VISIT_IF,
+    STAT_VISIT_WHILE,
+    /* whole rd set copies and equality tests */
+    STAT_SET_COPIES,
+    STAT_SET_COMPARES,
+    /* arena traffic */
+    STAT_ARENA_OBJECTS,
+    STAT_ARENA_BYTES,
+    STAT_ARENA_CHUNKS,
+    /* if branches and block halves handed to other workers, and those run
+     * in place instead */
+    STAT_FORKS_SPAWNED,
+    STAT_FORKS_INLINED,
+    STAT_N
+};
+
+/* process-wide instrumentation. everything is off until enable is called, and
+ * while off every hook is one test of a static flag. counters are atomic, so
+ * hooks may run on any thread. */
+class Stats {
+private:
+    /* loop bucket b counts loops that needed [2^b, 2^(b+1)) iterations */
+    static const unsigned LOOP_BUCKETS = 16;
+
+    struct Event {
+        std::string name;
+        std::string arg;
+        /* microseconds since enable */
+        double ts, dur;
+        unsigned tid;
+    };
+
+    static bool _on;
+    static std::chrono::steady_clock::time_point _epoch;
+    static std::atomic<uint64_t> _counters[STAT_N];
+    static std::atomic<uint64_t> _loops[LOOP_BUCKETS];
+    /* guards _events */
+    static std::mutex _lock;
+    static std::vector<Event> _events;
+
+    static unsigned tid(void);
+
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static void enable(void);
+
+    static bool on(void) { return Stats::_on; }
+
+    static void count(StatCounter c, uint64_t n = 1) {
+        if (Stats::_on) {
+            Stats::_counters[c].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    /* records that a while loop reached its fixed point after iters passes */
+    static void loop(unsigned long iters);
+    /* records a finished phase */
+    static void phase(const char *name,
+                      const std::string &arg,
+                      Clock::time_point start);
+    /* phases, counters and the loop histogram as a table */
+    static void summary(std::ostream &os);
+    /* phases as chrome trace events */
+    static void trace(const std::string &path);
+};
+
+/* times the enclosing scope as one phase. arg is shown with the event. */
+class StatPhase {
+private:
+    const char *_name;
+    std::string _arg;
+    Stats::Clock::time_point _start;
+
+    StatPhase(void);
+    StatPhase(const StatPhase &);
+    StatPhase &operator=(const StatPhase &);
+
+public:
+    StatPhase(const char *name, const std::string &arg) : _name(name) {
+        if (Stats::on()) {
+            this->_arg = arg;
+            this->_start = Stats::Clock::now();
+        }
+    }
+
+    ~StatPhase(void) {
+        if (Stats::on()) Stats::phase(this->_name, this->_arg, this->_start);
+    }
+};
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StreamPainter.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+
+#include <string>
+
+#include <string.h>
+#include <errno.h>
+
+using namespace std;
+
+const size_t StreamPainter::BUFSZ = 1 << 16;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+StreamPainter::StreamPainter(string prefix, string type, Format format) :
+    Painter(prefix, type), _format(format), _first(true)
+{
+    string fname = this->target();
+
+    if (NULL == (this->_fp = fopen(fname.c_str(), "w"))) {
+        int err = errno;
+        string estr = "cannot open: " + fname + ". why: " +
+                      strerror(err) + ".";
+        throw DFlowException(DFLOW_WHERE, estr);
+    }
+    this->_buf.reserve(2 * BUFSZ);
+    switch (this->_format) {
+        case DOT:
+            this->put("digraph ast {\n");
+            break;
+        case JSON:
+            this->put("{\"directed\":true,\"elements\":[");
+            break;
+        case GRAPHML:
+            this->put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                      "<graphml xmlns=\"http://graphml.graphdrawing.org/"
+                      "xmlns\">\n"
+                      "<key id=\"label\" for=\"node\" attr.name=\"label\" "
+                      "attr.type=\"string\"/>\n"
+                      "<graph id=\"ast\" edgedefault=\"directed\">\n");
+            break;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+StreamPainter::~StreamPainter(void)
+{
+    if (this->_fp) fclose(this->_fp);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+StreamPainter::put(PNode n)
+{
+    char digits[16];
+    char *p = digits + sizeof(digits);
+
+    *--p = '\0';
+    do {
+        *--p = char('0' + n % 10);
+        n /= 10;
+    } while (n);
+    this->_buf += p;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+StreamPainter::putLabel(const string &label)
+{
+    for (char c : label) {
+        switch (this->_format) {
+            case DOT:
+            case JSON:
+                if ('"' == c || '\\' == c) {
+                    this->_buf += '\\';
+                    this->_buf += c;
+                }
+                else if ('\n' == c) this->_buf += "\\n";
+                else if ((unsigned char)c < 0x20) this->_buf += ' ';
+                else this->_buf += c;
+                break;
+            case GRAPHML:
+                if ('&' == c) this->_buf += "&amp;";
+                else if ('<' == c) this->_buf += "&lt;";
+                else if ('>' == c) this->_buf += "&gt;";
+                else if ('"' == c) this->_buf += "&quot;";
+                else this->_buf += c;
+                break;
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+StreamPainter::flush(void)
+{
+    size_t n = this->_buf.size();
+
+    if (n && n != fwrite(this->_buf.data(), 1, n, this->_fp)) {
+        int err = errno;
+        string estr = "cannot write: " + this->target() + ". why: " +
+                      strerror(err) + ".";
+        throw DFlowException(DFLOW_WHERE, estr);
+    }
+    this->_buf.clear();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+StreamPainter::node(PNode n, const string &label)
+{
+    switch (this->_format) {
+        case DOT:
+            this->put("n"); this->put(n); this->put(" [label=\"");
+            this->putLabel(label);
+            this->put("\"];\n");
+            break;
+        case JSON:
+            this->put(this->_first ? "\n" : ",\n");
+            this->_first = false;
+            this->put("{\"node\":"); this->put(n); this->put(",\"label\":\"");
+            this->putLabel(label);
+            this->put("\"}");
+            break;
+        case GRAPHML:
+            this->put("<node id=\"n"); this->put(n);
+            this->put("\"><data key=\"label\">"); this->putLabel(label);
+            this->put("</data></node>\n");
+            break;
+    }
+    if (this->_buf.size() >= BUFSZ) this->flush();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+StreamPainter::edge(PNode n1, PNode n2)
+{
+    switch (this->_format) {
+        case DOT:
+            this->put("n"); this->put(n1);
+            this->put(" -> n"); this->put(n2); this->put(";\n");
+            break;
+        case JSON:
+            this->put(this->_first ? "\n" : ",\n");
+            this->_first = false;
+            this->put("{\"edge\":["); this->put(n1);
+            this->put(","); this->put(n2); this->put("]}");
+            break;
+        case GRAPHML:
+            this->put("<edge source=\"n"); this->put(n1);
+            this->put("\" target=\"n"); this->put(n2); this->put("\"/>\n");
+            break;
+    }
+    if (this->_buf.size() >= BUFSZ) this->flush();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+StreamPainter::renderAST(void)
+{
+    if (!this->_fp) return;
+    switch (this->_format) {
+        case DOT:
+            this->put("}\n");
+            break;
+        case JSON:
+            this->put("\n]}\n");
+            break;
+        case GRAPHML:
+            this->put("</graph>\n</graphml>\n");
+            break;
+    }
+    this->flush();
+    FILE *fp = this->_fp;
+    this->_fp = NULL;
+    if (0 != fclose(fp)) {
+        int err = errno;
+        string estr = "cannot close: " + this->target() + ". why: " +
+                      strerror(err) + ".";
+        throw DFlowException(DFLOW_WHERE, estr);
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STREAM_PAINTER_H_INCLUDED
+#define STREAM_PAINTER_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "Painter.hxx"
+
+#include <string>
+#include <cstdio>
+
+/* writes nodes and edges to prefix.type as they are emitted. nothing about
+ * the graph is kept, so memory use is the output buffer alone. */
+class StreamPainter : public Painter {
+public:
+    enum Format {
+        DOT = 0,
+        JSON,
+        GRAPHML
+    };
+
+private:
+    Format _format;
+    FILE *_fp;
+    /* pending output, written out whenever it grows past BUFSZ */
+    std::string _buf;
+    /* json only: no comma before the first element */
+    bool _first;
+
+    static const size_t BUFSZ;
+
+    StreamPainter(void);
+
+    void put(const char *s) { this->_buf += s; }
+
+    void put(PNode n);
+    /* label, escaped for the output format */
+    void putLabel(const std::string &label);
+
+    void flush(void);
+
+protected:
+    virtual void node(PNode n, const std::string &label);
+
+    virtual void edge(PNode n1, PNode n2);
+
+public:
+    StreamPainter(std::string prefix, std::string type, Format format);
+    /* closes the file, finished or not */
+    virtual ~StreamPainter(void);
+    /* writes the trailer and closes the file */
+    virtual void renderAST(void);
+};
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SymbolTable.hxx"
+
+#include <algorithm>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* FNV-1a */
+size_t
+SymbolTable::KeyHash::operator()(const Key &k) const
+{
+    size_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < k.len; ++i) {
+        h ^= static_cast<unsigned char>(k.s[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+varid
+SymbolTable::intern(const char *name, size_t len)
+{
+    Key k = {name, len};
+    auto it = this->_ids.find(k);
+    if (this->_ids.end() != it) return it->second;
+
+    varid v = this->_names.size();
+    this->_names.push_back(string(name, len));
+    k.s = this->_names.back().data();
+    this->_ids.insert(make_pair(k, v));
+    return v;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+unsigned
+SymbolTable::rank(varid v) const
+{
+    if (this->_rank.size() != this->_names.size()) {
+        vector<varid> byname(this->_names.size());
+        for (varid i = 0; i < byname.size(); ++i) byname[i] = i;
+        sort(byname.begin(), byname.end(), [this](varid a, varid b) {
+            return this->_names[a] < this->_names[b];
+        });
+        this->_rank.resize(byname.size());
+        for (unsigned r = 0; r < byname.size(); ++r) {
+            this->_rank[byname[r]] = r;
+        }
+    }
+    return this->_rank[v];
+}
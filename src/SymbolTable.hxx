@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYMBOL_TABLE_H_INCLUDED
+#define SYMBOL_TABLE_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+#include <cstring>
+
+/* dense variable id */
+typedef unsigned varid;
+
+/* interns variable names. ids are handed out in order of first appearance
+ * and names are only needed again when printing. */
+class SymbolTable {
+private:
+    /* a name that is not necessarily terminated */
+    struct Key {
+        const char *s;
+        size_t len;
+
+        bool operator==(const Key &o) const {
+            return this->len == o.len && 0 == memcmp(this->s, o.s, this->len);
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &k) const;
+    };
+    /* id -> name. a deque, so references to names stay valid. */
+    std::deque<std::string> _names;
+    /* name -> id. keys point into _names. */
+    std::unordered_map<Key, varid, KeyHash> _ids;
+    /* id -> position in name order. built on demand. */
+    mutable std::vector<unsigned> _rank;
+
+    SymbolTable(const SymbolTable &);
+    SymbolTable &operator=(const SymbolTable &);
+
+public:
+    SymbolTable(void) { ; }
+
+    ~SymbolTable(void) { ; }
+
+    varid intern(const std::string &name) {
+        return this->intern(name.data(), name.size());
+    }
+    /* the len chars at name are only copied the first time they are seen */
+    varid intern(const char *name, size_t len);
+
+    const std::string &name(varid v) const { return this->_names[v]; }
+
+    size_t size(void) const { return this->_names.size(); }
+    /* position of v when all names are sorted */
+    unsigned rank(varid v) const;
+};
+
+#endif
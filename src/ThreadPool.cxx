@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.hxx"
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+ThreadPool::ThreadPool(unsigned nthreads) : _stop(false)
+{
+    if (0 == nthreads) nthreads = 1;
+    for (unsigned i = 0; i < nthreads; ++i) {
+        this->_workers.push_back(thread(&ThreadPool::work, this));
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+ThreadPool::~ThreadPool(void)
+{
+    {
+        lock_guard<mutex> g(this->_lock);
+        this->_stop = true;
+    }
+    this->_ready.notify_all();
+    for (auto &w : this->_workers) w.join();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ThreadPool::submit(function<void(void)> task, bool urgent)
+{
+    {
+        lock_guard<mutex> g(this->_lock);
+        if (urgent) this->_tasks.push_front(move(task));
+        else this->_tasks.push_back(move(task));
+    }
+    this->_ready.notify_one();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+ThreadPool::work(void)
+{
+    while (true) {
+        function<void(void)> task;
+        {
+            unique_lock<mutex> g(this->_lock);
+            this->_ready.wait(g, [this] {
+                return this->_stop || !this->_tasks.empty();
+            });
+            if (this->_tasks.empty()) return;
+            task = move(this->_tasks.front());
+            this->_tasks.pop_front();
+        }
+        task();
+    }
+}
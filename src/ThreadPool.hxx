@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_H_INCLUDED
+#define THREAD_POOL_H_INCLUDED
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/* a fixed set of worker threads running queued tasks in order. urgent tasks
+ * go to the front of the queue. */
+class ThreadPool {
+private:
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void(void)> > _tasks;
+    std::mutex _lock;
+    std::condition_variable _ready;
+    bool _stop;
+
+    ThreadPool(void);
+    ThreadPool(const ThreadPool &);
+    ThreadPool &operator=(const ThreadPool &);
+
+    void work(void);
+
+public:
+    explicit ThreadPool(unsigned nthreads);
+    /* runs whatever is still queued, then joins */
+    ~ThreadPool(void);
+
+    void submit(std::function<void(void)> task, bool urgent = false);
+
+    unsigned size(void) const { return this->_workers.size(); }
+};
+
+#endif
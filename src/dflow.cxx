@@ -19,48 +19,467 @@
 #include <cstdlib>
 #include <cstdio>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
 
-#include <string.h>
-#include <errno.h>
+#include <getopt.h>
 
+#include "Arena.hxx"
+#include "Cache.hxx"
 #include "Constants.hxx"
 #include "DFlowException.hxx"
+#include "FlatAST.hxx"
+#include "Options.hxx"
 #include "Painter.hxx"
+#include "ParseContext.hxx"
 #include "Program.hxx"
-
-extern int parserParse(FILE *fp);
-/* can safely be used AFTER call to parseAppSource */
-extern Block *programRoot;
+#include "SourceBuffer.hxx"
+#include "Stats.hxx"
+#include "SymbolTable.hxx"
+#include "ThreadPool.hxx"
 
 using namespace std;
 
+/* part of every cache key. bump the suffix whenever the output for the same
+ * source and settings changes. */
+#ifdef PACKAGE_VERSION
+#define CACHE_VERSION PACKAGE_VERSION "-1"
+#else
+#define CACHE_VERSION "1"
+#endif
+
 /* ////////////////////////////////////////////////////////////////////////// */
 static void
 usage(void)
 {
     cout << endl << "usage:" << endl;
-    cout << "dflow appsrc" << endl;
+    cout << "dflow [--rd-engine=" << Options::rdEngines() << "]" << endl
+         << "      [--analyses=live,available,very-busy,def-use]" << endl
+         << "      [--rd-threads=N] [--rd-fork-threshold=N]" << endl
+         << "      [--scanner=" << Options::scanEngines() << "] [--jobs=N] "
+         << "[--manifest=file|-]" << endl
+         << "      [--draw=dot|json|graphml|png|svg|...] [--stats[=trace]]"
+         << endl
+         << "      [--cache=dir] [--cache-max=MB] [--emit-ast] [--load-ast]"
+         << endl
+         << "      [appsrc ...]" << endl;
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
+/* appends the analyses named in the comma-separated list to as */
 static void
-parseAppSource(string what)
+dfAnalyses(string names, vector<DFAnalysis> &as)
 {
-    FILE *fp = NULL;
+    istringstream is(names);
+    string name;
 
-    if (NULL == (fp = fopen(what.c_str(), "r"))) {
-        int err = errno;
-        string estr = "cannot open: " + what + ". why: " + strerror(err) + ".";
-        throw DFlowException(DFLOW_WHERE, estr);
+    while (getline(is, name, ',')) {
+        if ("live" == name) as.push_back(DF_LIVE);
+        else if ("available" == name) as.push_back(DF_AVAILABLE);
+        else if ("very-busy" == name) as.push_back(DF_VERY_BUSY);
+        else if ("def-use" == name) as.push_back(DF_DEF_USE);
+        else {
+            throw DFlowException(DFLOW_WHERE, "unknown analysis: " + name,
+                                 false);
+        }
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* appends the paths listed in manifest, one per line, to paths. - is stdin. */
+static void
+readManifest(string manifest, vector<string> &paths)
+{
+    ifstream file;
+    istream *in = &cin;
+    string line;
+
+    if ("-" != manifest) {
+        file.open(manifest.c_str());
+        if (!file) {
+            throw DFlowException(DFLOW_WHERE, "cannot open: " + manifest);
+        }
+        in = &file;
+    }
+    while (getline(*in, line)) {
+        if (!line.empty()) paths.push_back(line);
     }
-    if (0 != parserParse(fp)) {
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* returns the program's top-level block, which lives in arena. parse errors
+ * go to os and scanner complaints to es. */
+static Block *
+parseAppSource(ostream &os,
+               ostream &es,
+               SourceBuffer &src,
+               Arena &arena,
+               SymbolTable &syms,
+               ScanEngine se)
+{
+    ParseContext ctx(&arena, &syms, se);
+
+    ctx.out = &os;
+    ctx.err = &es;
+    if (0 != parserParse(src.data(), src.size(), ctx) || NULL == ctx.root) {
         string estr = "error encountered during source parse. cannot continue.";
         throw DFlowException(DFLOW_WHERE, estr);
     }
-    if (NULL != fp) {
-        fclose(fp);
+    return ctx.root;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* the first thing printed for every input. everything after it is the same
+ * for the same source and settings, which is what the cache keeps. */
+static string
+banner(const string &appsrc)
+{
+    return "> generating AST from " + appsrc + " ... ";
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static Block *
+parseStage(ostream &os,
+           ostream &es,
+           string appsrc,
+           SourceBuffer &src,
+           Arena &arena,
+           SymbolTable &syms,
+           ScanEngine se)
+{
+    os << banner(appsrc);
+    Block *programRoot = NULL;
+    {
+        StatPhase ph("parse", appsrc);
+        programRoot = parseAppSource(os, es, src, arena, syms, se);
+    }
+    os << "done" << endl;
+    if (Stats::on()) {
+        os << "> -- arena: " << arena.nobjs() << " objects, "
+           << arena.bytes() << " bytes" << endl;
+    }
+    return programRoot;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* points f at an --emit-ast image. nothing is copied but the names. */
+static void
+loadStage(ostream &os,
+          const string &appsrc,
+          SourceBuffer &image,
+          FlatAST &f,
+          SymbolTable &syms)
+{
+    os << banner(appsrc);
+    {
+        StatPhase ph("loadAST", appsrc);
+        f.load(image.data(), image.size(), syms);
+    }
+    os << "done" << endl;
+    os << "> -- image: " << f.size() << " nodes, " << image.size()
+       << " bytes" << endl;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* lays out and renders diagrams on a background thread */
+class Renderer {
+private:
+    Paintings _dias;
+    /* input the diagrams are of */
+    string _what;
+    thread _worker;
+    exception_ptr _error;
+
+    void work(void) {
+        try {
+            StatPhase ph("render", this->_what);
+            for (Painter *p : this->_dias) p->renderAST();
+        }
+        catch (...) {
+            this->_error = current_exception();
+        }
+    }
+
+public:
+    explicit Renderer(const string &what) : _what(what) { ; }
+
+    ~Renderer(void) {
+        if (this->_worker.joinable()) this->_worker.join();
+        for (Painter *p : this->_dias) delete p;
+    }
+
+    Paintings &dias(void) { return this->_dias; }
+
+    void start(void) { this->_worker = thread(&Renderer::work, this); }
+    /* waits for the renders and reports what was written */
+    void finish(ostream &os) {
+        if (!this->_worker.joinable()) return;
+        this->_worker.join();
+        if (this->_error) rethrow_exception(this->_error);
+        for (Painter *p : this->_dias) {
+            os << "> -- wrote " << p->target() << endl;
+        }
+    }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* writes appsrc.ast, the labeled program as an image --load-ast maps */
+static void
+emitImage(ostream &os,
+          const string &appsrc,
+          const Block *programRoot,
+          const SymbolTable &syms)
+{
+    const string target = appsrc + ".ast";
+    FlatAST f;
+
+    programRoot->flatten(f);
+    f.depth();
+    f.label();
+    ofstream file(target.c_str(), ios::binary);
+    if (!file) {
+        throw DFlowException(DFLOW_WHERE, "cannot open: " + target);
+    }
+    f.save(file, syms);
+    file.close();
+    if (!file) {
+        throw DFlowException(DFLOW_WHERE, "cannot write: " + target);
+    }
+    os << "> -- wrote " << target << endl;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+analyzeStage(ostream &os,
+             const string &appsrc,
+             Block *programRoot,
+             const SymbolTable &syms,
+             const Settings &set)
+{
+    Renderer renderer(appsrc);
+
+    os << "> generating source from AST ... " << endl;
+    os << "> -- setting nesting depths ... ";
+    {
+        StatPhase ph("depth", appsrc);
+        programRoot->depth(0);
+    }
+    os << "done" << endl;
+    os << "> -- labeling ... ";
+    int label = 0;
+    {
+        StatPhase ph("label", appsrc);
+        programRoot->label(label);
+    }
+    os << "> -- gathering variables ... " << endl;
+    {
+        StatPhase ph("gatherVars", appsrc);
+        programRoot->gatherVars(syms);
+    }
+    os << "> -- " << programRoot->nvars() << " found ..." << endl;
+    os << "> -- "; programRoot->emitVars(os, syms);
+    if (set.emitAst) {
+        StatPhase ph("emitAST", appsrc);
+        emitImage(os, appsrc, programRoot, syms);
+    }
+    if (!set.draw.empty()) {
+        StatPhase ph("draw", appsrc);
+        os << "> -- drawing " << appsrc << " diagrams ..." << endl;
+        programRoot->drawASTs(appsrc, set.draw, renderer.dias());
+        programRoot->drawCFG(appsrc, set.draw, renderer.dias());
+        /* overlaps with the analysis */
+        renderer.start();
+    }
+    {
+        StatPhase ph("rdcalc", appsrc);
+        programRoot->rdcalc(os, syms, set.rde, set.rdthreads, set.forkmin);
+    }
+    for (DFAnalysis a : set.analyses) {
+        StatPhase ph("dfcalc", appsrc);
+        programRoot->dfcalc(os, syms, a);
+    }
+    renderer.finish(os);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* analyzeStage for a mapped image. depths and labels come with it, and the
+ * flat engine needs nothing else. */
+static void
+analyzeImage(ostream &os,
+             const string &appsrc,
+             FlatAST &f,
+             const SymbolTable &syms)
+{
+    os << "> generating source from AST ... " << endl;
+    os << "> -- setting nesting depths ... done" << endl;
+    os << "> -- labeling ... ";
+    os << "> -- gathering variables ... " << endl;
+    os << "> -- " << syms.size() << " found ..." << endl;
+    os << "> -- "; Node::emitVars(os, syms, syms.size());
+    StatPhase ph("rdcalc", appsrc);
+    os << "> -- starting fixed point iteration ..." << endl;
+    f.rdcalc(os, syms, syms.size());
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* one input's trip through the batch pipeline */
+struct Job {
+    string path;
+    /* owns the AST and all parser temporaries */
+    Arena arena;
+    /* every variable name in the program */
+    SymbolTable syms;
+    Block *root;
+    /* the input. kept past parsing only for an image, which flat points
+     * into. */
+    unique_ptr<SourceBuffer> src;
+    FlatAST flat;
+    /* what this input prints to stdout and stderr */
+    ostringstream out, err;
+    bool failed;
+    /* guarded by the batch lock */
+    bool done;
+    /* cache entry the output goes to. empty when not caching. */
+    string key;
+
+    Job(const string &p) : path(p), root(NULL), failed(false), done(false) { ; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* state shared by every job in a batch */
+struct Batch {
+    const Settings &set;
+    mutex lock;
+    condition_variable finished;
+    /* last, so workers are joined before anything else goes away */
+    ThreadPool pool;
+
+    Batch(unsigned njobs, const Settings &s) : set(s), pool(njobs) { ; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+finishJob(Batch *b, Job *j)
+{
+    lock_guard<mutex> g(b->lock);
+    j->done = true;
+    b->finished.notify_all();
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+failJob(Batch *b, Job *j, const exception &e)
+{
+    j->err << e.what() << endl;
+    j->failed = true;
+    finishJob(b, j);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+analyzeJob(Batch *b, Job *j)
+{
+    try {
+        if (b->set.loadAst) analyzeImage(j->out, j->path, j->flat, j->syms);
+        else analyzeStage(j->out, j->path, j->root, j->syms, b->set);
+        /* only clean runs are worth replaying */
+        if (!j->key.empty() && j->err.str().empty()) {
+            string out = j->out.str();
+            b->set.cache->store(j->key, out.substr(banner(j->path).size()));
+        }
+    }
+    catch (exception &e) {
+        failJob(b, j, e);
+        return;
+    }
+    finishJob(b, j);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* queues the job's analysis ahead of parses that have not started yet, so
+ * the next input's parse overlaps this one's analysis. an input the cache
+ * already has is done as soon as its bytes are hashed. */
+static void
+parseJob(Batch *b, Job *j)
+{
+    Cache *cache = b->set.cache;
+
+    try {
+        j->src.reset(new SourceBuffer(j->path));
+        /* diagrams and images are files next to the input, so they always
+         * need a run */
+        if (cache && b->set.draw.empty() && !b->set.emitAst) {
+            string text;
+            j->key = cache->key(j->src->data(), j->src->size());
+            if (cache->load(j->key, text)) {
+                j->out << banner(j->path) << text;
+                finishJob(b, j);
+                return;
+            }
+        }
+        if (b->set.loadAst) {
+            loadStage(j->out, j->path, *j->src, j->flat, j->syms);
+        }
+        else {
+            j->root = parseStage(j->out, j->err, j->path, *j->src, j->arena,
+                                 j->syms, b->set.se);
+            j->src.reset();
+        }
+    }
+    catch (exception &e) {
+        failJob(b, j, e);
+        return;
+    }
+    b->pool.submit(bind(analyzeJob, b, j), true);
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* runs every path through parse and analysis on njobs threads. output is
+ * printed in input order, as soon as an input and everything before it is
+ * done. */
+static int
+runBatch(const vector<string> &paths,
+         unsigned njobs,
+         const Settings &set)
+{
+    /* bounds how many inputs are held in memory at once */
+    const size_t window = 2 * size_t(njobs);
+    /* inputs analyzed at once */
+    const size_t busy = max<size_t>(1, min<size_t>(njobs, paths.size()));
+    vector<unique_ptr<Job> > jobs(paths.size());
+    /* --rd-threads is the solver thread budget for the whole run, so each of
+     * the busy inputs gets its share */
+    Settings each = set;
+    each.rdthreads = max<size_t>(1, set.rdthreads / busy);
+    Batch b(njobs, each);
+    size_t next = 0;
+    int rc = EXIT_SUCCESS;
+
+    for (size_t emit = 0; emit < jobs.size(); ++emit) {
+        for (; next < jobs.size() && next - emit < window; ++next) {
+            jobs[next].reset(new Job(paths[next]));
+            b.pool.submit(bind(parseJob, &b, jobs[next].get()));
+        }
+        Job *j = jobs[emit].get();
+        {
+            unique_lock<mutex> g(b.lock);
+            b.finished.wait(g, [j] { return j->done; });
+        }
+        cout << j->out.str() << flush;
+        cerr << j->err.str() << flush;
+        if (j->failed) rc = EXIT_FAILURE;
+        /* done with its AST */
+        jobs[emit].reset();
     }
+    return rc;
 }
 
 /* ////////////////////////////////////////////////////////////////////////// */
@@ -68,33 +487,167 @@ parseAppSource(string what)
 int
 main(int argc, char **argv)
 {
-    if (2 != argc) {
+    static struct option lopts[] = {
+        {"rd-engine", required_argument, NULL, 'e'},
+        {"scanner", required_argument, NULL, 's'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"manifest", required_argument, NULL, 'm'},
+        {"rd-threads", required_argument, NULL, 't'},
+        {"rd-fork-threshold", required_argument, NULL, 'f'},
+        {"draw", required_argument, NULL, 'd'},
+        {"analyses", required_argument, NULL, 'a'},
+        {"stats", optional_argument, NULL, 'S'},
+        {"cache", required_argument, NULL, 'c'},
+        {"cache-max", required_argument, NULL, 'C'},
+        {"emit-ast", no_argument, NULL, 'E'},
+        {"load-ast", no_argument, NULL, 'L'},
+        {NULL, 0, NULL, 0}
+    };
+    /* the engine defaults to map, or to flat for images */
+    string engine, scanner = "fast", manifest, analyses;
+    /* where --stats writes its trace. empty means no stats. */
+    string trace;
+    /* --cache directory and its cap in megabytes */
+    string cachedir;
+    uint64_t cachemax = 512;
+    unique_ptr<Cache> cache;
+    unsigned njobs = thread::hardware_concurrency();
+    Settings set;
+    vector<string> paths;
+    int c, rc = EXIT_SUCCESS;
+
+    while (-1 != (c = getopt_long(argc, argv, "e:s:j:m:t:f:d:a:S::c:C:EL",
+                                  lopts, NULL))) {
+        switch (c) {
+            case 'e':
+                engine = optarg;
+                break;
+            case 's':
+                scanner = optarg;
+                break;
+            case 'j':
+                if (Options::number(optarg, njobs, Options::MAXTHREADS)) {
+                    break;
+                }
+                usage();
+                return EXIT_FAILURE;
+            case 'm':
+                manifest = optarg;
+                break;
+            case 't':
+                if (Options::number(optarg, set.rdthreads,
+                                    Options::MAXTHREADS)) {
+                    break;
+                }
+                usage();
+                return EXIT_FAILURE;
+            case 'f':
+                if (Options::number(optarg, set.forkmin)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'd':
+                set.draw = optarg;
+                break;
+            case 'a':
+                analyses = optarg;
+                break;
+            case 'S':
+                trace = optarg ? optarg : "dflow-trace.json";
+                break;
+            case 'c':
+                cachedir = optarg;
+                break;
+            case 'C':
+                /* megabytes, shifted into bytes below */
+                if (Options::number(optarg, cachemax, UINT64_MAX >> 20)) {
+                    break;
+                }
+                usage();
+                return EXIT_FAILURE;
+            case 'E':
+                set.emitAst = true;
+                break;
+            case 'L':
+                set.loadAst = true;
+                break;
+            default:
+                usage();
+                return EXIT_FAILURE;
+        }
+    }
+    for (int i = optind; i < argc; ++i) paths.push_back(argv[i]);
+    if (paths.empty() && manifest.empty()) {
         usage();
         return EXIT_FAILURE;
     }
+    if (0 == njobs) njobs = 1;
+    if (0 == set.rdthreads) set.rdthreads = 1;
     try {
-        /* do this before we ever touch programRoot */
-        cout << "> generating AST from " + string(argv[1]) + " ... ";
-        parseAppSource(string(argv[1]));
-        cout << "done" << endl;
-        cout << "> generating source from AST ... " << endl;
-        cout << "> -- setting nesting depths ... ";
-        programRoot->depth(0);
-        cout << "done" << endl;
-        cout << "> -- labeling ... ";
-        int label = 0;
-        programRoot->label(label);
-        cout << "> -- gathering variables ... " << endl;
-        programRoot->gatherVars();
-        /* rm any cruft */
-        programRoot->varclean();
-        cout << "> -- " << programRoot->nvars() << " found ..." << endl;
-        cout << "> -- "; programRoot->emitVars();
-        programRoot->rdcalc();
+        if (engine.empty()) engine = set.loadAst ? "flat" : "map";
+        set.rde = Options::rdEngine(engine);
+        if (set.loadAst && (RD_ENGINE_FLAT != set.rde || !analyses.empty() ||
+                            !set.draw.empty() || set.emitAst)) {
+            throw DFlowException(DFLOW_WHERE, "--load-ast images only "
+                                 "support the flat rd engine, without "
+                                 "--analyses, --draw or --emit-ast", false);
+        }
+        set.se = Options::scanEngine(scanner);
+        dfAnalyses(analyses, set.analyses);
+        if (!manifest.empty()) readManifest(manifest, paths);
+        if (!trace.empty()) Stats::enable();
+        if (!cachedir.empty()) {
+            /* everything besides the source that changes the output */
+            string salt = string("dflow ") + CACHE_VERSION +
+                          " rd=" + engine +
+                          " threads=" + to_string(set.rdthreads) +
+                          " fork=" + to_string(set.forkmin) +
+                          " analyses=" + analyses +
+                          /* adds the arena line */
+                          " stats=" + (trace.empty() ? "off" : "on");
+            cache.reset(new Cache(cachedir, cachemax << 20, salt));
+            set.cache = cache.get();
+        }
+        /* the batch path captures each input's output, which caching needs */
+        if (1 != paths.size() || !manifest.empty() || set.cache) {
+            rc = runBatch(paths, njobs, set);
+        }
+        else {
+            /* owns the AST and all parser temporaries */
+            Arena arena;
+            /* every variable name in the program */
+            SymbolTable syms;
+            if (set.loadAst) {
+                SourceBuffer image(paths[0]);
+                /* points into image */
+                FlatAST f;
+                loadStage(cout, paths[0], image, f, syms);
+                analyzeImage(cout, paths[0], f, syms);
+            }
+            else {
+                Block *programRoot = NULL;
+                {
+                    SourceBuffer src(paths[0]);
+                    programRoot = parseStage(cout, cerr, paths[0], src,
+                                             arena, syms, set.se);
+                }
+                analyzeStage(cout, paths[0], programRoot, syms, set);
+            }
+        }
+        if (!trace.empty()) {
+            Stats::summary(cout);
+            Stats::trace(trace);
+            cout << "> stats: wrote " << trace << endl;
+        }
+        if (set.cache) {
+            cout << "> cache: " << cache->hits() << " hits, "
+                 << cache->misses() << " misses, " << cache->stores()
+                 << " stored, " << cache->evictions() << " evicted in "
+                 << cache->dir() << endl;
+        }
     }
     catch (DFlowException &e) {
         cerr << e.what() << endl;
         return EXIT_FAILURE;
     }
-    return EXIT_SUCCESS;
+    return rc;
 }
@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include <getopt.h>
+#include <sys/resource.h>
+
+#include "Arena.hxx"
+#include "Constants.hxx"
+#include "DFlowException.hxx"
+#include "Options.hxx"
+#include "Painter.hxx"
+#include "ParseContext.hxx"
+#include "Program.hxx"
+#include "SourceBuffer.hxx"
+#include "SymbolTable.hxx"
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* the pipeline phases, in the order dflow runs them */
+enum Phase {
+    PH_PARSE = 0,
+    PH_DEPTH,
+    PH_LABEL,
+    PH_GATHER_VARS,
+    PH_RDCALC,
+    PH_DRAW_ASTS,
+    PH_DRAW_CFG,
+    PH_N
+};
+
+static const char *phaseNames[PH_N] = {
+    "parse", "depth", "label", "gatherVars", "rdcalc", "drawASTs", "drawCFG"
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* one phase's best time */
+struct Sample {
+    double secs;
+
+    Sample(void) : secs(-1.0) { ; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* swallows the analysis report so only the solver is timed */
+class NullBuf : public streambuf {
+protected:
+    virtual int overflow(int c) { return traits_type::not_eof(c); }
+
+    virtual streamsize xsputn(const char *, streamsize n) { return n; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* times phases and keeps the fastest of every run */
+class Stopwatch {
+private:
+    typedef chrono::steady_clock Clock;
+    Sample *_samples;
+    Clock::time_point _start;
+
+public:
+    explicit Stopwatch(Sample *samples) : _samples(samples) { ; }
+
+    void start(void) { this->_start = Clock::now(); }
+
+    void stop(Phase p) {
+        double secs = chrono::duration<double>(Clock::now() -
+                                               this->_start).count();
+        Sample &s = this->_samples[p];
+
+        if (s.secs < 0.0 || secs < s.secs) s.secs = secs;
+    }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+usage(void)
+{
+    cout << endl << "usage:" << endl;
+    cout << "dflowbench [--rd-engine=" << Options::rdEngines() << "]"
+         << endl
+         << "           [--rd-threads=N] [--rd-fork-threshold=N]" << endl
+         << "           [--scanner=" << Options::scanEngines() << "] "
+         << "[--draw=dot|json|graphml|...]" << endl
+         << "           [--no-draw] [--repeat=N] appsrc ..." << endl;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* runs the whole pipeline over appsrc once, folding times into samples.
+ * returns the number of labels. the scanner works in place, so every run
+ * maps its own buffer. */
+static int
+runOnce(const string &appsrc,
+        const Settings &set,
+        size_t &bytes,
+        Sample *samples)
+{
+    Stopwatch sw(samples);
+    SourceBuffer src(appsrc);
+    Arena arena;
+    SymbolTable syms;
+    ParseContext ctx(&arena, &syms, set.se);
+    NullBuf nbuf;
+    ostream null(&nbuf);
+    Paintings dias;
+    int label = 0;
+
+    ctx.out = &cerr;
+    ctx.err = &cerr;
+    bytes = src.size();
+    sw.start();
+    if (0 != parserParse(src.data(), src.size(), ctx) ||
+        NULL == ctx.root) {
+        string estr = "error encountered during source parse. cannot continue.";
+        throw DFlowException(DFLOW_WHERE, estr);
+    }
+    sw.stop(PH_PARSE);
+    Block *programRoot = ctx.root;
+
+    sw.start();
+    programRoot->depth(0);
+    sw.stop(PH_DEPTH);
+
+    sw.start();
+    programRoot->label(label);
+    sw.stop(PH_LABEL);
+
+    sw.start();
+    programRoot->gatherVars(syms);
+    sw.stop(PH_GATHER_VARS);
+
+    sw.start();
+    programRoot->rdcalc(null, syms, set.rde, set.rdthreads, set.forkmin);
+    sw.stop(PH_RDCALC);
+
+    if (!set.draw.empty()) {
+        try {
+            /* a draw is timed through its layout and render */
+            sw.start();
+            programRoot->drawASTs(appsrc, set.draw, dias);
+            for (Painter *p : dias) p->renderAST();
+            sw.stop(PH_DRAW_ASTS);
+            size_t nasts = dias.size();
+            sw.start();
+            programRoot->drawCFG(appsrc, set.draw, dias);
+            for (size_t i = nasts; i < dias.size(); ++i) dias[i]->renderAST();
+            sw.stop(PH_DRAW_CFG);
+        }
+        catch (...) {
+            for (Painter *p : dias) delete p;
+            throw;
+        }
+        for (Painter *p : dias) delete p;
+    }
+    return label;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* one json object per input on a single line. the rss is the process's peak
+ * so far, which covers every input before this one too: getrusage has no
+ * per-phase figure. */
+static void
+report(ostream &os,
+       const string &appsrc,
+       size_t bytes,
+       int labels,
+       const Sample *samples)
+{
+    struct rusage ru;
+    long peakKB = (0 == getrusage(RUSAGE_SELF, &ru)) ? ru.ru_maxrss : 0;
+
+    os << "{\"input\":" << Options::quote(appsrc) << ",\"bytes\":" << bytes
+       << ",\"labels\":" << labels << ",\"peak_rss_kb\":" << peakKB
+       << ",\"phases\":{";
+    bool first = true;
+    for (int p = 0; p < PH_N; ++p) {
+        const Sample &s = samples[p];
+        if (s.secs < 0.0) continue;
+        /* parse throughput is in bytes, everything else in labels */
+        double work = (PH_PARSE == p) ? double(bytes) : double(labels);
+        double rate = (s.secs > 0.0) ? work / s.secs : 0.0;
+        os << (first ? "" : ",") << Options::quote(phaseNames[p])
+           << ":{\"secs\":" << s.secs << ",\"rate\":" << rate << "}";
+        first = false;
+    }
+    os << "}}" << endl;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(int argc, char **argv)
+{
+    static struct option lopts[] = {
+        {"rd-engine", required_argument, NULL, 'e'},
+        {"rd-threads", required_argument, NULL, 't'},
+        {"rd-fork-threshold", required_argument, NULL, 'f'},
+        {"scanner", required_argument, NULL, 's'},
+        {"draw", required_argument, NULL, 'd'},
+        {"no-draw", no_argument, NULL, 'D'},
+        {"repeat", required_argument, NULL, 'r'},
+        {NULL, 0, NULL, 0}
+    };
+    Settings set;
+    unsigned repeat = 1;
+    int c;
+
+    try {
+        while (-1 != (c = getopt_long(argc, argv, "e:t:f:s:d:Dr:", lopts,
+                                      NULL))) {
+            switch (c) {
+                case 'e':
+                    set.rde = Options::rdEngine(optarg);
+                    break;
+                case 't':
+                    if (Options::number(optarg, set.rdthreads,
+                                        Options::MAXTHREADS)) {
+                        break;
+                    }
+                    usage();
+                    return EXIT_FAILURE;
+                case 'f':
+                    if (Options::number(optarg, set.forkmin)) break;
+                    usage();
+                    return EXIT_FAILURE;
+                case 's':
+                    set.se = Options::scanEngine(optarg);
+                    break;
+                case 'd':
+                    set.draw = optarg;
+                    break;
+                case 'D':
+                    set.draw.clear();
+                    break;
+                case 'r':
+                    if (Options::number(optarg, repeat)) break;
+                    usage();
+                    return EXIT_FAILURE;
+                default:
+                    usage();
+                    return EXIT_FAILURE;
+            }
+        }
+        if (optind == argc || 0 == repeat || 0 == set.rdthreads) {
+            usage();
+            return EXIT_FAILURE;
+        }
+        cout.precision(9);
+        for (int i = optind; i < argc; ++i) {
+            string appsrc(argv[i]);
+            Sample samples[PH_N];
+            size_t bytes = 0;
+            int labels = 0;
+            for (unsigned r = 0; r < repeat; ++r) {
+                labels = runOnce(appsrc, set, bytes, samples);
+            }
+            report(cout, appsrc, bytes, labels, samples);
+        }
+    }
+    catch (DFlowException &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
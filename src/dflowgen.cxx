@@ -0,0 +1,341 @@
+/**
+ * Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits>
+
+#include <stdint.h>
+#include <getopt.h>
+
+using namespace std;
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* generator knobs */
+struct Knobs {
+    /* statements to emit, counting if and while tests */
+    unsigned long statements;
+    /* distinct variables */
+    unsigned vars;
+    /* chance that a statement is an if */
+    double branch;
+    /* chance that a statement is a while */
+    double loop;
+    /* deepest while nesting */
+    unsigned loopDepth;
+    /* deepest nesting of ifs and whiles together */
+    unsigned nest;
+    /* mean statements per nested block */
+    unsigned block;
+    /* if not 0, one chain this deep replaces the random program */
+    unsigned long deep;
+    uint64_t seed;
+
+    Knobs(void) :
+        statements(1000), vars(16), branch(0.1), loop(0.05), loopDepth(3),
+        nest(8), block(4), deep(0), seed(1) { ; }
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* while-language program generator. a small hand-rolled prng keeps output
+ * identical across standard libraries for a given seed. */
+class Generator {
+private:
+    const Knobs &_k;
+    ostream &_os;
+    uint64_t _state;
+    unsigned long _left;
+
+    Generator(void);
+
+    uint64_t next(void) {
+        /* xorshift64* */
+        this->_state ^= this->_state >> 12;
+        this->_state ^= this->_state << 25;
+        this->_state ^= this->_state >> 27;
+        return this->_state * 2685821657736338717ULL;
+    }
+
+    unsigned below(unsigned n) { return unsigned(this->next() % n); }
+
+    /* uniform in [0, 1) from the top 53 bits */
+    double unit(void) {
+        return (this->next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    void pad(unsigned depth) {
+        for (unsigned i = 0; i < depth; ++i) this->_os << "    ";
+    }
+
+    /* identifiers are letters only, so spell the index in base 26 */
+    void var(void) {
+        char buf[16];
+        unsigned v = this->below(this->_k.vars), n = 0;
+        do { buf[n++] = char('a' + v % 26); v /= 26; } while (v);
+        this->_os << 'v';
+        while (n) this->_os << buf[--n];
+    }
+
+    void num(void) {
+        if (this->below(4)) this->_os << this->below(100);
+        else this->_os << this->below(100) << "." << this->below(100);
+    }
+
+    void operand(void) {
+        if (this->below(3)) this->var();
+        else this->num();
+    }
+
+    void rhs(void) {
+        static const char *ops[] = {"+", "-", "*", "/"};
+        unsigned r = this->below(10);
+        if (r < 6) {
+            this->operand();
+            this->_os << " " << ops[this->below(4)] << " ";
+            this->var();
+        }
+        else if (r < 8) {
+            this->var();
+        }
+        else {
+            this->num();
+        }
+    }
+
+    void test(void) {
+        static const char *ops[] = {"<", "<=", ">", ">=", "=="};
+        unsigned r = this->below(10);
+        if (r < 7) {
+            this->var();
+            this->_os << " " << ops[this->below(5)] << " ";
+            this->operand();
+        }
+        else if (r < 9) {
+            this->_os << "!";
+            this->var();
+        }
+        else {
+            this->var();
+        }
+    }
+
+    void block(unsigned depth, unsigned loops, unsigned long n);
+
+    void statement(unsigned depth, unsigned loops);
+
+public:
+    Generator(const Knobs &k, ostream &os) :
+        _k(k), _os(os), _state(k.seed ? k.seed : 1), _left(k.statements) { ; }
+
+    void run(void) {
+        if (this->_k.deep) this->chain(this->_k.deep);
+        else while (this->_left) this->statement(0, 0);
+    }
+
+    void chain(unsigned long n);
+};
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* emits up to n statements, always at least one */
+void
+Generator::block(unsigned depth, unsigned loops, unsigned long n)
+{
+    if (0 == n) n = 1;
+    for (unsigned long i = 0; i < n && (0 == i || this->_left); ++i) {
+        this->statement(depth, loops);
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+void
+Generator::statement(unsigned depth, unsigned loops)
+{
+    double r = this->unit();
+    /* between 1 and twice the mean */
+    unsigned long n = 1 + this->below(2 * this->_k.block);
+
+    if (this->_left) --this->_left;
+    if (depth < this->_k.nest && r < this->_k.branch) {
+        this->pad(depth); this->_os << "if "; this->test();
+        this->_os << " then" << endl;
+        this->block(depth + 1, loops, n);
+        this->pad(depth); this->_os << "else" << endl;
+        this->block(depth + 1, loops, 1 + this->below(2 * this->_k.block));
+        this->pad(depth); this->_os << "fi" << endl;
+    }
+    else if (depth < this->_k.nest && loops < this->_k.loopDepth &&
+             r < this->_k.branch + this->_k.loop) {
+        this->pad(depth); this->_os << "while "; this->test();
+        this->_os << " do" << endl;
+        this->block(depth + 1, loops + 1, n);
+        this->pad(depth); this->_os << "od" << endl;
+    }
+    else if (0 == this->below(20)) {
+        this->pad(depth); this->_os << "skip;" << endl;
+    }
+    else {
+        this->pad(depth); this->var(); this->_os << " = "; this->rhs();
+        this->_os << ";" << endl;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* n ifs and whiles, each the only statement of the last one's body, around
+ * one assignment. a level is a while with the --loop chance. nothing is
+ * indented, which would make the output quadratic in n, and nothing
+ * recurses, so any depth the parser takes can be written. */
+void
+Generator::chain(unsigned long n)
+{
+    /* whiles, one bit per level */
+    vector<bool> loops(n);
+
+    for (unsigned long d = 0; d < n; ++d) {
+        loops[d] = this->unit() < this->_k.loop;
+        this->_os << (loops[d] ? "while " : "if ");
+        this->test();
+        this->_os << (loops[d] ? " do" : " then") << endl;
+    }
+    this->var(); this->_os << " = "; this->rhs(); this->_os << ";" << endl;
+    while (n--) {
+        if (loops[n]) this->_os << "od" << endl;
+        else this->_os << "else" << endl << "skip;" << endl << "fi" << endl;
+    }
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* a whole decimal number that fits in n. strtoull alone skips blanks and
+ * takes a sign, wrapping -1 around. */
+template <typename T>
+static bool
+number(const char *s, T &n)
+{
+    char *end = NULL;
+
+    if (!isdigit(static_cast<unsigned char>(*s))) return false;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (0 != errno || '\0' != *end || v > numeric_limits<T>::max()) {
+        return false;
+    }
+    n = static_cast<T>(v);
+    return true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* a probability, from 0 to 1 */
+static bool
+chance(const char *s, double &p)
+{
+    char *end = NULL;
+
+    errno = 0;
+    double v = strtod(s, &end);
+    if (end == s || 0 != errno || '\0' != *end || !(v >= 0.0 && v <= 1.0)) {
+        return false;
+    }
+    p = v;
+    return true;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+static void
+usage(void)
+{
+    cout << endl << "usage:" << endl;
+    cout << "dflowgen [--statements=N] [--vars=N] [--branch=P] [--loop=P]"
+         << endl
+         << "         [--loop-depth=N] [--nest=N] [--block=N] [--seed=N]"
+         << endl
+         << "         [--deep=N]" << endl;
+}
+
+/* ////////////////////////////////////////////////////////////////////////// */
+/* ////////////////////////////////////////////////////////////////////////// */
+int
+main(int argc, char **argv)
+{
+    static struct option lopts[] = {
+        {"statements", required_argument, NULL, 'n'},
+        {"vars", required_argument, NULL, 'v'},
+        {"branch", required_argument, NULL, 'b'},
+        {"loop", required_argument, NULL, 'l'},
+        {"loop-depth", required_argument, NULL, 'd'},
+        {"nest", required_argument, NULL, 'N'},
+        {"block", required_argument, NULL, 'k'},
+        {"seed", required_argument, NULL, 's'},
+        {"deep", required_argument, NULL, 'D'},
+        {NULL, 0, NULL, 0}
+    };
+    Knobs k;
+    int c;
+
+    while (-1 != (c = getopt_long(argc, argv, "n:v:b:l:d:N:k:s:D:", lopts,
+                                  NULL))) {
+        switch (c) {
+            case 'n':
+                if (number(optarg, k.statements)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'v':
+                if (number(optarg, k.vars)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'b':
+                if (chance(optarg, k.branch)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'l':
+                if (chance(optarg, k.loop)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'd':
+                if (number(optarg, k.loopDepth)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'N':
+                if (number(optarg, k.nest)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'k':
+                if (number(optarg, k.block)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 's':
+                if (number(optarg, k.seed)) break;
+                usage();
+                return EXIT_FAILURE;
+            case 'D':
+                if (number(optarg, k.deep)) break;
+                usage();
+                return EXIT_FAILURE;
+            default:
+                usage();
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc || 0 == k.vars || 0 == k.block) {
+        usage();
+        return EXIT_FAILURE;
+    }
+    Generator(k, cout).run();
+    return EXIT_SUCCESS;
+}
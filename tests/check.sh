@@ -0,0 +1,117 @@
+#!/bin/sh
+#
+# Copyright (c) 2020 Samuel K. Gutierrez All rights reserved.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# runs dflow over every sample next to this script and checks that each
+# rd engine agrees with the map engine, that both scanners read it the
+# same, that an image written by --emit-ast analyzes the same under
+# --load-ast, and that --cache replays what a run printed. DFLOW names the
+# binary to check.
+
+here=$(cd "$(dirname "$0")" && pwd)
+dflow=${DFLOW:-$here/../src/dflow}
+tmp=$(mktemp -d) || exit 1
+trap 'rm -rf "$tmp"' EXIT
+fails=0
+
+fail() {
+    echo "FAIL: $*"
+    fails=$((fails + 1))
+}
+
+# engines report their own progress line, and an image starts from its
+# own path, so those lines are left out of every comparison
+normalize() {
+    sed -e 's/^> -- done .*/> -- done .../' \
+        -e '/^> generating AST from /d' \
+        -e '/^> -- wrote /d' \
+        -e '/^> -- image: /d'
+}
+
+# the samples are copied so nothing is written into the source tree
+mkdir "$tmp/in"
+samples=
+for f in $(cd "$here" && find . -type f ! -name '*.sh' | sort); do
+    s=$tmp/in/$(echo "$f" | sed -e 's|^\./||' -e 's|/|-|g')
+    cp "$here/$f" "$s"
+    samples="$samples $s"
+done
+
+engines=$("$dflow" | sed -n 's/.*--rd-engine=\([a-z|]*\)\].*/\1/p' |
+          tr '|' ' ')
+if [ -z "$engines" ]; then
+    echo "FAIL: cannot list the rd engines of $dflow"
+    exit 1
+fi
+
+for s in $samples; do
+    n=$(basename "$s")
+    "$dflow" "$s" 2>&1 | normalize > "$tmp/$n.map"
+    for e in $engines; do
+        for t in 1 4; do
+            "$dflow" --rd-engine="$e" --rd-threads=$t --rd-fork-threshold=1 \
+                "$s" 2>&1 | normalize > "$tmp/$n.out"
+            cmp -s "$tmp/$n.map" "$tmp/$n.out" ||
+                fail "$n: --rd-engine=$e --rd-threads=$t differs from map"
+        done
+    done
+done
+
+# the hand-written scanner must read every sample the way flex does
+for s in $samples; do
+    n=$(basename "$s")
+    "$dflow" --scanner=flex "$s" > "$tmp/$n.flex" 2>&1
+    "$dflow" --scanner=fast "$s" > "$tmp/$n.out" 2>&1
+    cmp -s "$tmp/$n.flex" "$tmp/$n.out" ||
+        fail "$n: --scanner=fast differs from --scanner=flex"
+done
+
+# an image must analyze the same as the source it was written from
+for s in $samples; do
+    n=$(basename "$s")
+    "$dflow" --emit-ast "$s" > /dev/null 2>&1 ||
+        fail "$n: --emit-ast failed"
+    "$dflow" --load-ast "$s.ast" 2>&1 | normalize > "$tmp/$n.out"
+    cmp -s "$tmp/$n.map" "$tmp/$n.out" ||
+        fail "$n: --load-ast differs from a fresh parse"
+done
+
+# a cache hit must replay what the miss printed in the same mode. --stats
+# adds arena lines, so each mode is run cold before either is run warm,
+# which catches one mode replaying the other's entries. the cache summary
+# and the stats tables legitimately differ between a hit and a miss.
+for run in miss hit; do
+    for mode in plain stats; do
+        opt=
+        if [ stats = $mode ]; then opt=--stats=$tmp/trace.json; fi
+        "$dflow" --cache="$tmp/cache" $opt $samples 2>&1 |
+            sed -e '/^> cache:/d' -e '/^> stats:/,$d' > "$tmp/$mode.$run"
+    done
+done
+for mode in plain stats; do
+    cmp -s "$tmp/$mode.miss" "$tmp/$mode.hit" ||
+        fail "cache: a hit differs from the miss with $mode output"
+done
+grep -q '^> -- arena:' "$tmp/plain.hit" &&
+    fail "cache: arena lines replayed without --stats"
+grep -q '^> -- arena:' "$tmp/stats.hit" ||
+    fail "cache: arena lines missing under --stats"
+
+if [ 0 -ne $fails ]; then
+    echo "$fails failures"
+    exit 1
+fi
+exit 0